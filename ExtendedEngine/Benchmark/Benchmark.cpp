@@ -0,0 +1,227 @@
+// Benchmark.cpp : Times the hot paths of the extended engine
+// Every result is written as a single line of JSON so runs can be diffed between releases
+//
+// Usage: Benchmark.exe [media folder] [sound file] [output file]
+// The media folder must contain Quad.x and Transparent.png, the sound file is optional
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <string>
+
+#include "ExtendedEngine.h"
+
+using namespace tle;
+
+namespace
+{
+	//Fixed frame time used for every update so that runs are reproducible
+	const float kFrameTime = 1.0f / 60.0f;
+
+	//Number of untimed runs before measuring and the number of timed runs
+	const int kWarmUpRuns = 3;
+	const int kTimedRuns = 15;
+
+	//Timing results for a single benchmark at a single size
+	struct SResult
+	{
+		string mName;
+		int mSize;
+		int mIterations;
+		double mMedianUs;
+		double mMinUs;
+		double mMaxUs;
+	};
+
+	//Runs the function the warm up amount of times then times each of the timed runs
+	//Each run calls the function iterations amount of times
+	template<class TFunc>
+	SResult Measure(const string& name, int size, int iterations, TFunc func)
+	{
+		using Clock = std::chrono::high_resolution_clock;
+
+		for (int run = 0; run < kWarmUpRuns; ++run)
+		{
+			for (int i = 0; i < iterations; ++i) func();
+		}
+
+		std::vector<double> samples;
+		for (int run = 0; run < kTimedRuns; ++run)
+		{
+			auto start = Clock::now();
+			for (int i = 0; i < iterations; ++i) func();
+			auto end = Clock::now();
+
+			//Time per iteration in microseconds
+			samples.push_back(std::chrono::duration<double, std::micro>(end - start).count() / iterations);
+		}
+		std::sort(samples.begin(), samples.end());
+
+		return SResult{ name, size, iterations, samples[samples.size() / 2], samples.front(), samples.back() };
+	}
+
+	//Writes the result as one line of JSON
+	void Write(std::ostream& out, const SResult& result)
+	{
+		out << "{\"benchmark\":\"" << result.mName << "\""
+			<< ",\"size\":" << result.mSize
+			<< ",\"iterations\":" << result.mIterations
+			<< ",\"median_us\":" << result.mMedianUs
+			<< ",\"min_us\":" << result.mMinUs
+			<< ",\"max_us\":" << result.mMaxUs
+			<< "}" << std::endl;
+	}
+
+	/************************************
+				Benchmarks
+	*************************************/
+
+	//Steady state update of a single emitter holding roughly size particles
+	SResult ParticleUpdate(IEngine* engine, int size)
+	{
+		const float rate = 0.01f;
+
+		IParticleEmitter* emitter = engine->CreateEmitter(EEmissionType::Line, PARTICLE_TEXTURE, rate);
+		emitter->SetRandomSeed(1);
+		emitter->SetFixedTimestep(kFrameTime);
+		emitter->SetParticleLife(rate * size);
+		emitter->SetParticleVelocity(CVector3(0.0f, 0.0001f, 0.0f));
+		emitter->Start();
+
+		//A single update of the particle's life time fills the emitter
+		emitter->Update(rate * size);
+
+		SResult result = Measure("particle_update", size, 10, [&]() { emitter->Update(kFrameTime); });
+
+		//Kill the particles first so the emitter is destroyed instead of left dying, where the engine's timer
+		//would go on updating its particles during the later benchmarks
+		emitter->Reset();
+		engine->RemoveEmitter(emitter);
+		return result;
+	}
+
+	//Takes size models out of the model cache then puts them back
+	SResult ModelCacheChurn(IEngine* engine, int size)
+	{
+		IMesh* mesh = engine->LoadMesh(PARTICLE_MODEL);
+		engine->Load(PARTICLE_MODEL, size, PARTICLE_TEXTURE);
+
+		std::vector<IModel*> models(size);
+		SResult result = Measure("model_cache_churn", size, 10, [&]()
+		{
+			for (int i = 0; i < size; ++i) models[i] = engine->GetModel(mesh, PARTICLE_TEXTURE);
+			for (int i = 0; i < size; ++i) engine->CacheModel(models[i], PARTICLE_TEXTURE);
+		});
+
+		engine->ClearModelCache();
+		return result;
+	}
+
+	//Automatic update of size looping animations, stepped by the fixed frame time so every step moves them a frame
+	SResult AnimationUpdate(IEngine* engine, int size)
+	{
+		const std::vector<string> frames(8, PARTICLE_TEXTURE);
+
+		std::vector<IAnimation*> animations;
+		for (int i = 0; i < size; ++i)
+		{
+			animations.push_back(engine->CreateAnimation(frames, CVector3(0.0f, 0.0f, 0.0f), kFrameTime));
+		}
+
+		SResult result = Measure("animation_update", size, 10, [&]() { engine->StepAutoUpdates(kFrameTime); });
+
+		for (auto animation = animations.begin(); animation != animations.end(); ++animation)
+		{
+			engine->RemoveAnimation(*animation);
+		}
+		return result;
+	}
+
+	//Queues size models across a manifest of textures then loads them all
+	SResult LoadQueue(IEngine* engine, int size)
+	{
+		const int manifestEntries = 10;
+
+		SResult result = Measure("load_queued_objects", size, 1, [&]()
+		{
+			for (int i = 0; i < manifestEntries; ++i)
+			{
+				engine->AddToLoadQueue(PARTICLE_MODEL, size / manifestEntries, i % 2 ? PARTICLE_TEXTURE : "");
+			}
+			engine->LoadQueuedObjects(0);
+			engine->ClearModelCache();
+		});
+
+		return result;
+	}
+
+	//Changes the sound effect volume with size sounds alive
+	SResult SoundVolume(IEngine* engine, int size, const string& soundFile)
+	{
+		std::vector<ISound*> sounds;
+		for (int i = 0; i < size; ++i)
+		{
+			sounds.push_back(engine->CreateSound(soundFile));
+		}
+
+		float volume = 0.0f;
+		SResult result = Measure("sound_set_volume", size, 10, [&]()
+		{
+			volume = volume > 99.0f ? 0.0f : volume + 1.0f;
+			engine->SetVolume(volume, SoundType::SFX);
+		});
+
+		engine->ClearSounds();
+		return result;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const string mediaFolder = argc > 1 ? argv[1] : "./Media";
+	const string soundFile = argc > 2 ? argv[2] : "";
+	const string outputFile = argc > 3 ? argv[3] : "";
+
+	IEngine* engine = NewEngine();
+	engine->StartWindowed();
+	engine->AddMediaFolder(mediaFolder);
+	engine->CreateCamera(kManual);
+
+	//Updates are driven manually with the fixed frame time
+	engine->PauseAutoUpdates();
+
+	const int sizes[] = { 100, 1000, 10000 };
+	std::vector<SResult> results;
+
+	for (int size : sizes) results.push_back(ParticleUpdate(engine, size));
+	for (int size : sizes) results.push_back(ModelCacheChurn(engine, size));
+	for (int size : sizes) results.push_back(AnimationUpdate(engine, size / 10));
+	for (int size : sizes) results.push_back(LoadQueue(engine, size));
+
+	//Only benchmark sound if a file has been provided and it can be loaded
+	if (soundFile != "" && engine->CreateSound(soundFile))
+	{
+		engine->ClearSounds();
+		for (int size : sizes) results.push_back(SoundVolume(engine, size, soundFile));
+	}
+
+	engine->Delete();
+
+	for (auto result = results.begin(); result != results.end(); ++result)
+	{
+		Write(std::cout, *result);
+	}
+
+	if (outputFile != "")
+	{
+		std::ofstream out(outputFile);
+		for (auto result = results.begin(); result != results.end(); ++result)
+		{
+			Write(out, *result);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,29 @@
+// CVector3.h : In-memory stand-in for the TL-Xtreme vector class
+
+#pragma once
+
+namespace tlx
+{
+	const float kfPi = 3.1415926535897932f;
+
+	class CVector3
+	{
+	public:
+		float x;
+		float y;
+		float z;
+
+		CVector3() : x(0.0f), y(0.0f), z(0.0f) {}
+		CVector3(const float fX, const float fY, const float fZ) : x(fX), y(fY), z(fZ) {}
+
+		CVector3& operator+=(const CVector3& v) { x += v.x; y += v.y; z += v.z; return *this; }
+		CVector3& operator-=(const CVector3& v) { x -= v.x; y -= v.y; z -= v.z; return *this; }
+		CVector3& operator*=(const float s) { x *= s; y *= s; z *= s; return *this; }
+	};
+
+	inline CVector3 operator+(const CVector3& a, const CVector3& b) { return CVector3(a.x + b.x, a.y + b.y, a.z + b.z); }
+	inline CVector3 operator-(const CVector3& a, const CVector3& b) { return CVector3(a.x - b.x, a.y - b.y, a.z - b.z); }
+	inline CVector3 operator*(const CVector3& v, const float s) { return CVector3(v.x * s, v.y * s, v.z * s); }
+	inline CVector3 operator*(const float s, const CVector3& v) { return CVector3(v.x * s, v.y * s, v.z * s); }
+	inline float Dot(const CVector3& a, const CVector3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+// Camera.h : In-memory stand-in for the TL-Engine camera interface
+
+#pragma once
+#include "SceneNode.h"
+
+namespace tle
+{
+	enum ECameraType { kManual, kFPS, kTargeted };
+
+	class ICamera : virtual public ISceneNode
+	{
+	};
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+// Common.h : In-memory stand-in for the TL-Engine's common definitions
+// Only what the extension and the benchmark use is declared, nothing is drawn
+
+#pragma once
+#include <string>
+
+// Tracing macros of the TL-Engine, they do nothing here
+#define TL_CLASS(name)
+#define TL_FN(name)
+#define TL_ENDFN
+
+namespace tle
+{
+	using std::string;
+
+	typedef unsigned int TUInt32;
+}
\ No newline at end of file
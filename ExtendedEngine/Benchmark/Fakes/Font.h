@@ -0,0 +1,13 @@
+// Font.h : In-memory stand-in for the TL-Engine font interface
+
+#pragma once
+#include "Common.h"
+
+namespace tle
+{
+	class IFont
+	{
+	public:
+		virtual ~IFont() {}
+	};
+}
\ No newline at end of file
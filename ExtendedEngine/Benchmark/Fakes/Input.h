@@ -0,0 +1,17 @@
+// Input.h : In-memory stand-in for the TL-Engine key codes
+// No input is ever received so only a few codes are declared
+
+#pragma once
+
+namespace tle
+{
+	enum EKeyCode
+	{
+		Mouse_LButton = 0x01,
+		Mouse_RButton = 0x02,
+		Key_Escape = 0x1B,
+		Key_Space = 0x20,
+		Key_A = 0x41,
+		kMaxKeyCodes = 0x100
+	};
+}
\ No newline at end of file
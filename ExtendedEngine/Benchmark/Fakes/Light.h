@@ -0,0 +1,11 @@
+// Light.h : In-memory stand-in for the TL-Engine light interface
+
+#pragma once
+#include "SceneNode.h"
+
+namespace tle
+{
+	class ILight : virtual public ISceneNode
+	{
+	};
+}
\ No newline at end of file
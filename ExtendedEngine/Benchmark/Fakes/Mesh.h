@@ -0,0 +1,16 @@
+// Mesh.h : In-memory stand-in for the TL-Engine mesh interface
+
+#pragma once
+#include "Model.h"
+
+namespace tle
+{
+	class IMesh
+	{
+	public:
+		virtual IModel* CreateModel(const float fX = 0.0f, const float fY = 0.0f, const float fZ = 0.0f) = 0;
+		virtual void RemoveModel(IModel* pModel) = 0;
+
+		virtual ~IMesh() {}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+// Model.h : In-memory stand-in for the TL-Engine model interface
+
+#pragma once
+#include <string>
+#include "SceneNode.h"
+
+namespace tle
+{
+	class IMesh;
+
+	class IModel : virtual public ISceneNode
+	{
+	public:
+		virtual IMesh* GetMesh() = 0;
+		virtual void SetSkin(const std::string& sSkin) = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,3 @@
+// SDKDDKVer.h : Empty stand-in for the Windows SDK version header
+
+#pragma once
\ No newline at end of file
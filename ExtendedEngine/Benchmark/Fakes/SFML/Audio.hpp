@@ -0,0 +1,7 @@
+// Audio.hpp : In-memory SFML audio module
+
+#pragma once
+#include <SFML/Audio/SoundSource.hpp>
+#include <SFML/Audio/SoundBuffer.hpp>
+#include <SFML/Audio/Sound.hpp>
+#include <SFML/Audio/Music.hpp>
\ No newline at end of file
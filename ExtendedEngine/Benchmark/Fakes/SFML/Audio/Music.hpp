@@ -0,0 +1,22 @@
+// Music.hpp : In-memory SFML music, opening only checks the file exists
+
+#pragma once
+#include <fstream>
+#include <string>
+#include <SFML/Audio/SoundSource.hpp>
+
+namespace sf
+{
+	class Music : public SoundSource
+	{
+	public:
+		bool openFromFile(const std::string& filename)
+		{
+			std::ifstream file(filename);
+			return static_cast<bool>(file);
+		}
+
+		unsigned int getSampleRate() const { return 44100; }
+		unsigned int getChannelCount() const { return 2; }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+// Sound.hpp : In-memory SFML sound
+
+#pragma once
+#include <SFML/Audio/SoundSource.hpp>
+#include <SFML/Audio/SoundBuffer.hpp>
+
+namespace sf
+{
+	class Sound : public SoundSource
+	{
+	private:
+		const SoundBuffer* mpBuffer = 0;
+
+	public:
+		Sound() {}
+		Sound(const SoundBuffer& buffer) : mpBuffer(&buffer) {}
+
+		void setBuffer(const SoundBuffer& buffer) { mpBuffer = &buffer; }
+	};
+}
\ No newline at end of file
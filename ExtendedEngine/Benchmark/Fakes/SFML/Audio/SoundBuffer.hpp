@@ -0,0 +1,29 @@
+// SoundBuffer.hpp : In-memory SFML sound buffer, loading only checks the file exists and no samples are decoded
+
+#pragma once
+#include <fstream>
+#include <string>
+#include <SFML/Config.hpp>
+
+namespace sf
+{
+	class SoundBuffer
+	{
+	private:
+		Uint64 mSampleCount = 0;
+
+	public:
+		//Reports a second of 44.1KHz stereo sound for any file that exists
+		bool loadFromFile(const std::string& filename)
+		{
+			std::ifstream file(filename);
+			if (!file) return false;
+			mSampleCount = 44100 * 2;
+			return true;
+		}
+
+		Uint64 getSampleCount() const { return mSampleCount; }
+		unsigned int getSampleRate() const { return 44100; }
+		unsigned int getChannelCount() const { return 2; }
+	};
+}
\ No newline at end of file
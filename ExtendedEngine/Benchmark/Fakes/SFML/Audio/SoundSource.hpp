@@ -0,0 +1,41 @@
+// SoundSource.hpp : In-memory SFML sound source, keeps the state of a sound without playing anything
+
+#pragma once
+#include <SFML/Config.hpp>
+
+namespace sf
+{
+	class SoundSource
+	{
+	public:
+		enum Status { Stopped, Paused, Playing };
+
+	protected:
+		float mVolume = 100.0f;
+		bool mLoop = false;
+		Status mStatus = Stopped;
+
+	public:
+		void setVolume(float volume) { mVolume = volume; }
+		float getVolume() const { return mVolume; }
+		void setLoop(bool loop) { mLoop = loop; }
+		bool getLoop() const { return mLoop; }
+
+		void play() { mStatus = Playing; }
+		void pause() { if (mStatus == Playing) mStatus = Paused; }
+		void stop() { mStatus = Stopped; }
+		Status getStatus() const { return mStatus; }
+
+		virtual ~SoundSource() {}
+	};
+
+	class Listener
+	{
+	private:
+		static float& GlobalVolume() { static float volume = 100.0f; return volume; }
+
+	public:
+		static void setGlobalVolume(float volume) { GlobalVolume() = volume; }
+		static float getGlobalVolume() { return GlobalVolume(); }
+	};
+}
\ No newline at end of file
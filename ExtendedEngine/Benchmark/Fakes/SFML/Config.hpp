@@ -0,0 +1,9 @@
+// Config.hpp : Fixed size types of the in-memory SFML stand-in
+
+#pragma once
+
+namespace sf
+{
+	typedef short Int16;
+	typedef unsigned long long Uint64;
+}
\ No newline at end of file
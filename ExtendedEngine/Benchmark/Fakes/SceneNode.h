@@ -0,0 +1,60 @@
+// SceneNode.h : In-memory stand-in for the TL-Engine scene node interface
+
+#pragma once
+#include "Common.h"
+
+namespace tle
+{
+	class ISceneNode
+	{
+	public:
+		virtual float GetX() = 0;
+		virtual float GetY() = 0;
+		virtual float GetZ() = 0;
+		virtual float GetLocalX() = 0;
+		virtual float GetLocalY() = 0;
+		virtual float GetLocalZ() = 0;
+
+		virtual void SetX(const float fX) = 0;
+		virtual void SetY(const float fY) = 0;
+		virtual void SetZ(const float fZ) = 0;
+		virtual void SetPosition(const float fX, const float fY, const float fZ) = 0;
+		virtual void SetLocalX(const float fX) = 0;
+		virtual void SetLocalY(const float fY) = 0;
+		virtual void SetLocalZ(const float fZ) = 0;
+		virtual void SetLocalPosition(const float fX, const float fY, const float fZ) = 0;
+
+		virtual void MoveX(const float fX) = 0;
+		virtual void MoveY(const float fY) = 0;
+		virtual void MoveZ(const float fZ) = 0;
+		virtual void Move(const float fX, const float fY, const float fZ) = 0;
+		virtual void MoveLocalX(const float fX) = 0;
+		virtual void MoveLocalY(const float fY) = 0;
+		virtual void MoveLocalZ(const float fZ) = 0;
+		virtual void MoveLocal(const float fX, const float fY, const float fZ) = 0;
+
+		virtual void LookAt(ISceneNode* pTarget) = 0;
+		virtual void LookAt(const float fX, const float fY, const float fZ) = 0;
+		virtual void RotateX(const float fDegrees) = 0;
+		virtual void RotateY(const float fDegrees) = 0;
+		virtual void RotateZ(const float fDegrees) = 0;
+		virtual void RotateLocalX(const float fDegrees) = 0;
+		virtual void RotateLocalY(const float fDegrees) = 0;
+		virtual void RotateLocalZ(const float fDegrees) = 0;
+		virtual void ResetOrientation() = 0;
+
+		virtual void Scale(const float fScale) = 0;
+		virtual void ScaleX(const float fScale) = 0;
+		virtual void ScaleY(const float fScale) = 0;
+		virtual void ScaleZ(const float fScale) = 0;
+		virtual void ResetScale() = 0;
+
+		virtual void GetMatrix(float* pfMatrix) = 0;
+		virtual void SetMatrix(const float* pfMatrix) = 0;
+
+		virtual void AttachToParent(ISceneNode* pParent) = 0;
+		virtual void DetachFromParent() = 0;
+
+		virtual ~ISceneNode() {}
+	};
+}
\ No newline at end of file
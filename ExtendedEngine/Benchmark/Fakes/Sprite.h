@@ -0,0 +1,27 @@
+// Sprite.h : In-memory stand-in for the TL-Engine sprite interface
+
+#pragma once
+#include "Common.h"
+
+namespace tle
+{
+	class ISprite
+	{
+	public:
+		virtual float GetX() = 0;
+		virtual float GetY() = 0;
+		virtual float GetZ() = 0;
+
+		virtual void SetX(const float fX) = 0;
+		virtual void SetY(const float fY) = 0;
+		virtual void SetZ(const float fZ) = 0;
+		virtual void SetPosition(const float fX, const float fY) = 0;
+
+		virtual void MoveX(const float fX) = 0;
+		virtual void MoveY(const float fY) = 0;
+		virtual void MoveZ(const float fZ) = 0;
+		virtual void Move(const float fX, const float fY) = 0;
+
+		virtual ~ISprite() {}
+	};
+}
\ No newline at end of file
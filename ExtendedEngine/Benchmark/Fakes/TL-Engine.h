@@ -0,0 +1,77 @@
+// TL-Engine.h : In-memory stand-in for the TL-Engine interface
+// Lets the extension be built and benchmarked without the TL-Engine, see TLXEngine.cpp for the implementation
+// Nothing is drawn, scene nodes only keep their matrices and no files are read
+
+#pragma once
+#include <string>
+#include "Common.h"
+#include "CVector3.h"
+#include "SceneNode.h"
+#include "Model.h"
+#include "Mesh.h"
+#include "Camera.h"
+#include "Light.h"
+#include "Sprite.h"
+#include "Font.h"
+#include "Input.h"
+
+namespace tle
+{
+	class I3DEngine
+	{
+	public:
+		virtual bool StartFullscreen(const int iWidth = 1280, const int iHeight = 1024) = 0;
+		virtual void StartWindowed(const int iWidth = 1280, const int iHeight = 720) = 0;
+		virtual void Delete() = 0;
+		virtual void Stop() = 0;
+
+		virtual bool IsRunning() = 0;
+		virtual bool IsActive() = 0;
+		virtual int GetWindow() = 0;
+		virtual int GetWidth() = 0;
+		virtual int GetHeight() = 0;
+
+		virtual void AddMediaFolder(const string& sFolder) = 0;
+		virtual bool RemoveMediaFolder(const string& sFolder) = 0;
+		virtual void ClearMediaFolders() = 0;
+
+		virtual IMesh* LoadMesh(const string& sMeshFileName) = 0;
+		virtual void RemoveMesh(const IMesh* pMesh) = 0;
+
+		virtual ICamera* CreateCamera(const ECameraType eCameraType = kManual, const float fX = 0.0f, const float fY = 12.0f,
+									  const float fZ = -30.0f) = 0;
+		virtual void RemoveCamera(const ICamera* pCamera) = 0;
+
+		virtual void SetAmbientLight(const float fRed = 1.0f, const float fGreen = 1.0f, const float fBlue = 1.0f) = 0;
+		virtual ILight* CreatePointLight(const float fX = 0.0f, const float fY = 0.0f, const float fZ = 0.0f, const float fRed = 1.0f,
+										 const float fGreen = 1.0f, const float fBlue = 1.0f, const float fRadius = 100.0f) = 0;
+		virtual void RemoveLight(const ILight* pLight) = 0;
+
+		virtual ISprite* CreateSprite(const string& sSpriteName, const float fX = 0.0f, const float fY = 0.0f, const float fZ = 0.0f) = 0;
+		virtual void RemoveSprite(const ISprite* pSprite) = 0;
+
+		virtual void DrawScene(ICamera* pCamera = 0) = 0;
+
+		virtual void SetWindowCaption(const string& sText) = 0;
+		virtual IFont* DefaultFont() = 0;
+		virtual IFont* LoadFont(const string& sFontName, const unsigned int iSize = 24) = 0;
+		virtual void RemoveFont(const IFont* pFont) = 0;
+
+		virtual bool KeyHit(const EKeyCode eKeyCode) = 0;
+		virtual bool KeyHeld(const EKeyCode eKeyCode) = 0;
+		virtual bool AnyKeyHit() = 0;
+		virtual bool AnyKeyHeld() = 0;
+		virtual int GetMouseX() = 0;
+		virtual int GetMouseY() = 0;
+		virtual float GetMouseWheel() = 0;
+		virtual int GetMouseMovementX() = 0;
+		virtual int GetMouseMovementY() = 0;
+		virtual float GetMouseWheelMovement() = 0;
+		virtual void StartMouseCapture() = 0;
+		virtual void StopMouseCapture() = 0;
+
+		virtual float Timer() = 0;
+
+		virtual ~I3DEngine() {}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+// TLX-Engine.h : In-memory stand-in for the TL-Xtreme interfaces held by the TL-Engine wrapper
+// Only the render device, window and timer are created, they keep the little state the wrapper needs
+
+#pragma once
+#include <chrono>
+#include <list>
+#include <string>
+#include "CVector3.h"
+
+namespace tlx
+{
+	//Size of the surface drawn to and the folders searched for media
+	struct IRenderDevice
+	{
+		unsigned int mWidth;
+		unsigned int mHeight;
+		std::list<std::string> mResourceFolders;
+
+		unsigned int GetSurfaceWidth() { return mWidth; }
+		unsigned int GetSurfaceHeight() { return mHeight; }
+	};
+
+	//Whether the window has been closed
+	struct IOSWindow
+	{
+		bool mOpen;
+	};
+
+	//Time the timer was last read
+	struct IOSTimer
+	{
+		std::chrono::steady_clock::time_point mLast;
+	};
+
+	struct IRenderManager;
+	struct ISceneManager;
+	struct IMeshManager;
+	struct ITextureManager;
+	struct CInputReceiver;
+	struct CWindowReceiver;
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+// TLXCamera.h : In-memory camera, only keeps its matrix
+
+#pragma once
+#include "TL-Engine.h"
+#include "CTransformNode.h"
+
+namespace tle
+{
+	class CTLXCamera : public ICamera, public CTransformNode
+	{
+	};
+}
\ No newline at end of file
@@ -0,0 +1,305 @@
+// TLXEngine.cpp : In-memory implementation of the TL-Engine wrapper the extension derives from
+// Used in place of TLXEngineModified.cpp where the TL-Engine isn't available, such as the Linux benchmark build
+// Meshes are never read from disk and nothing is drawn, so timings only cover the extension's own work
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include "TLXEngineModified.h"
+
+namespace tle
+{
+	/********************************
+		Construction / Destruction
+	*********************************/
+
+	CTLXEngineMod::CTLXEngineMod()
+	{
+		m_pRenderDevice = 0;
+		m_pRenderManager = 0;
+		m_pSceneManager = 0;
+		m_pMeshManager = 0;
+		m_pTextureManager = 0;
+		m_MeshID = 0;
+
+		m_pInputReceiver = 0;
+		m_pWindowReceiver = 0;
+		m_pWindow = 0;
+		m_pTimer = 0;
+		m_pDefaultFont = 0;
+	}
+
+	CTLXEngineMod::~CTLXEngineMod()
+	{
+		for (auto it = m_Sprites.begin(); it != m_Sprites.end(); ++it) delete *it;
+		for (auto it = m_Fonts.begin(); it != m_Fonts.end(); ++it) delete *it;
+		for (auto it = m_Cameras.begin(); it != m_Cameras.end(); ++it) delete *it;
+		for (auto it = m_Lights.begin(); it != m_Lights.end(); ++it) delete *it;
+		for (auto it = m_Meshes.begin(); it != m_Meshes.end(); ++it) delete *it;
+
+		delete m_pRenderDevice;
+		delete m_pWindow;
+		delete m_pTimer;
+	}
+
+	/********************************
+		   Main control interface
+	*********************************/
+
+	bool CTLXEngineMod::StartFullscreen(const int iWidth, const int iHeight)
+	{
+		StartWindowed(iWidth, iHeight);
+		return true;
+	}
+
+	void CTLXEngineMod::StartWindowed(const int iWidth, const int iHeight)
+	{
+		m_pRenderDevice = new tlx::IRenderDevice();
+		m_pRenderDevice->mWidth = iWidth;
+		m_pRenderDevice->mHeight = iHeight;
+
+		m_pWindow = new tlx::IOSWindow();
+		m_pWindow->mOpen = true;
+
+		m_pTimer = new tlx::IOSTimer();
+		m_pTimer->mLast = std::chrono::steady_clock::now();
+
+		m_pDefaultFont = new CTLXFont();
+		m_Fonts.push_back(m_pDefaultFont);
+	}
+
+	void CTLXEngineMod::Delete()
+	{
+		delete this;
+	}
+
+	void CTLXEngineMod::Stop()
+	{
+		if (m_pWindow) m_pWindow->mOpen = false;
+	}
+
+	/********************************
+				Properties
+	*********************************/
+
+	bool CTLXEngineMod::IsRunning()
+	{
+		return m_pWindow && m_pWindow->mOpen;
+	}
+
+	bool CTLXEngineMod::IsActive()
+	{
+		return false;
+	}
+
+	int CTLXEngineMod::GetWindow()
+	{
+		return 0;
+	}
+
+	int CTLXEngineMod::GetWidth()
+	{
+		return m_pRenderDevice->GetSurfaceWidth();
+	}
+
+	int CTLXEngineMod::GetHeight()
+	{
+		return m_pRenderDevice->GetSurfaceHeight();
+	}
+
+	/********************************
+			   Media folders
+	*********************************/
+
+	void CTLXEngineMod::AddMediaFolder(const string& sFolder)
+	{
+		m_pRenderDevice->mResourceFolders.push_back(sFolder);
+	}
+
+	bool CTLXEngineMod::RemoveMediaFolder(const string& sFolder)
+	{
+		auto& folders = m_pRenderDevice->mResourceFolders;
+		auto folder = std::find(folders.begin(), folders.end(), sFolder);
+		if (folder == folders.end()) return false;
+
+		folders.erase(folder);
+		return true;
+	}
+
+	void CTLXEngineMod::ClearMediaFolders()
+	{
+		m_pRenderDevice->mResourceFolders.clear();
+	}
+
+	//Returns the path of the file in the first media folder that has it, or an empty string if none do
+	string CTLXEngineMod::FindMediaFile(const string& sFileName)
+	{
+		if (std::ifstream(sFileName)) return sFileName;
+
+		auto& folders = m_pRenderDevice->mResourceFolders;
+		for (auto folder = folders.begin(); folder != folders.end(); ++folder)
+		{
+			string path = *folder + "/" + sFileName;
+			if (std::ifstream(path)) return path;
+		}
+		return "";
+	}
+
+	/********************************
+				  Meshes
+	*********************************/
+
+	//Always succeeds as no geometry is needed to time the extension
+	IMesh* CTLXEngineMod::LoadMesh(const string& sMeshFileName)
+	{
+		CTLXMesh* mesh = new CTLXMesh(sMeshFileName);
+		m_Meshes.push_back(mesh);
+		++m_MeshID;
+		return mesh;
+	}
+
+	void CTLXEngineMod::RemoveMesh(const IMesh* pMesh)
+	{
+		TMeshListIter mesh = std::find(m_Meshes.begin(), m_Meshes.end(), pMesh);
+		if (mesh == m_Meshes.end()) return;
+
+		delete *mesh;
+		m_Meshes.erase(mesh);
+	}
+
+	/********************************
+			 Cameras and lights
+	*********************************/
+
+	ICamera* CTLXEngineMod::CreateCamera(const ECameraType eCameraType, const float fX, const float fY, const float fZ)
+	{
+		CTLXCamera* camera = new CTLXCamera();
+		camera->SetPosition(fX, fY, fZ);
+		m_Cameras.push_back(camera);
+		return camera;
+	}
+
+	void CTLXEngineMod::RemoveCamera(const ICamera* pCamera)
+	{
+		TCameraListIter camera = std::find(m_Cameras.begin(), m_Cameras.end(), pCamera);
+		if (camera == m_Cameras.end()) return;
+
+		delete *camera;
+		m_Cameras.erase(camera);
+	}
+
+	void CTLXEngineMod::SetAmbientLight(const float fRed, const float fGreen, const float fBlue)
+	{
+	}
+
+	ILight* CTLXEngineMod::CreatePointLight(const float fX, const float fY, const float fZ, const float fRed,
+											const float fGreen, const float fBlue, const float fRadius)
+	{
+		CTLXLight* light = new CTLXLight();
+		light->SetPosition(fX, fY, fZ);
+		m_Lights.push_back(light);
+		return light;
+	}
+
+	void CTLXEngineMod::RemoveLight(const ILight* pLight)
+	{
+		TLightListIter light = std::find(m_Lights.begin(), m_Lights.end(), pLight);
+		if (light == m_Lights.end()) return;
+
+		delete *light;
+		m_Lights.erase(light);
+	}
+
+	/********************************
+				  Sprites
+	*********************************/
+
+	ISprite* CTLXEngineMod::CreateSprite(const string& sSpriteName, const float fX, const float fY, const float fZ)
+	{
+		CTLXSprite* sprite = new CTLXSprite(fX, fY, fZ);
+		m_Sprites.push_back(sprite);
+		return sprite;
+	}
+
+	void CTLXEngineMod::RemoveSprite(const ISprite* pSprite)
+	{
+		TSpriteListIter sprite = std::find(m_Sprites.begin(), m_Sprites.end(), pSprite);
+		if (sprite == m_Sprites.end()) return;
+
+		delete *sprite;
+		m_Sprites.erase(sprite);
+	}
+
+	/********************************
+				 Rendering
+	*********************************/
+
+	void CTLXEngineMod::DrawScene(ICamera* pCamera)
+	{
+	}
+
+	/********************************
+				   GUI
+	*********************************/
+
+	void CTLXEngineMod::SetWindowCaption(const string& sText)
+	{
+	}
+
+	IFont* CTLXEngineMod::DefaultFont()
+	{
+		return m_pDefaultFont;
+	}
+
+	IFont* CTLXEngineMod::LoadFont(const string& sFontName, const unsigned int iSize)
+	{
+		CTLXFont* font = new CTLXFont();
+		m_Fonts.push_back(font);
+		return font;
+	}
+
+	void CTLXEngineMod::RemoveFont(const IFont* pFont)
+	{
+		TFontListIter font = std::find(m_Fonts.begin(), m_Fonts.end(), pFont);
+		if (font == m_Fonts.end()) return;
+
+		delete *font;
+		m_Fonts.erase(font);
+	}
+
+	/********************************
+				  Input
+	*********************************/
+
+	//No window means no input, nothing is ever pressed and the mouse never moves
+
+	bool CTLXEngineMod::KeyHit(const EKeyCode eKeyCode) { return false; }
+	bool CTLXEngineMod::KeyHeld(const EKeyCode eKeyCode) { return false; }
+	bool CTLXEngineMod::AnyKeyHit() { return false; }
+	bool CTLXEngineMod::AnyKeyHeld() { return false; }
+
+	int CTLXEngineMod::GetMouseX() { return 0; }
+	int CTLXEngineMod::GetMouseY() { return 0; }
+	float CTLXEngineMod::GetMouseWheel() { return 0.0f; }
+
+	int CTLXEngineMod::GetMouseMovementX() { return 0; }
+	int CTLXEngineMod::GetMouseMovementY() { return 0; }
+	float CTLXEngineMod::GetMouseWheelMovement() { return 0.0f; }
+
+	void CTLXEngineMod::StartMouseCapture() {}
+	void CTLXEngineMod::StopMouseCapture() {}
+
+	/********************************
+				  Timer
+	*********************************/
+
+	float CTLXEngineMod::Timer()
+	{
+		auto now = std::chrono::steady_clock::now();
+		float seconds = std::chrono::duration<float>(now - m_pTimer->mLast).count();
+		m_pTimer->mLast = now;
+		return seconds;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+// TLXFont.h : In-memory font, draws nothing
+
+#pragma once
+#include "TL-Engine.h"
+
+namespace tle
+{
+	class CTLXFont : public IFont
+	{
+	};
+}
\ No newline at end of file
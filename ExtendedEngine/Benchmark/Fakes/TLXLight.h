@@ -0,0 +1,12 @@
+// TLXLight.h : In-memory light, only keeps its matrix
+
+#pragma once
+#include "TL-Engine.h"
+#include "CTransformNode.h"
+
+namespace tle
+{
+	class CTLXLight : public ILight, public CTransformNode
+	{
+	};
+}
\ No newline at end of file
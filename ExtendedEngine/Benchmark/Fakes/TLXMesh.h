@@ -0,0 +1,56 @@
+// TLXMesh.h : In-memory mesh and model, no geometry is loaded and models only keep their matrix and skin
+
+#pragma once
+#include <unordered_set>
+#include "TL-Engine.h"
+#include "CTransformNode.h"
+
+namespace tle
+{
+	class CTLXModel : public IModel, public CTransformNode
+	{
+	private:
+		IMesh* mpMesh;
+		string mSkin;
+
+	public:
+		CTLXModel(IMesh* pMesh) : mpMesh(pMesh) {}
+
+		IMesh* GetMesh() { return mpMesh; }
+		void SetSkin(const string& sSkin) { mSkin = sSkin; }
+	};
+
+	class CTLXMesh : public IMesh
+	{
+	private:
+		string mFileName;
+		std::unordered_set<CTLXModel*> mModels;
+
+	public:
+		CTLXMesh(const string& sFileName) : mFileName(sFileName) {}
+
+		IModel* CreateModel(const float fX = 0.0f, const float fY = 0.0f, const float fZ = 0.0f)
+		{
+			CTLXModel* model = new CTLXModel(this);
+			model->SetPosition(fX, fY, fZ);
+			mModels.insert(model);
+			return model;
+		}
+
+		void RemoveModel(IModel* pModel)
+		{
+			CTLXModel* model = dynamic_cast<CTLXModel*>(pModel);
+			if (mModels.erase(model)) delete model;
+		}
+
+		const string& GetFileName() { return mFileName; }
+
+		~CTLXMesh()
+		{
+			for (auto model = mModels.begin(); model != mModels.end(); ++model)
+			{
+				delete *model;
+			}
+		}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+// TLXSprite.h : In-memory sprite, only keeps its position
+
+#pragma once
+#include "TL-Engine.h"
+
+namespace tle
+{
+	class CTLXSprite : public ISprite
+	{
+	private:
+		float mX;
+		float mY;
+		float mZ;
+
+	public:
+		CTLXSprite(const float fX, const float fY, const float fZ) : mX(fX), mY(fY), mZ(fZ) {}
+
+		float GetX() { return mX; }
+		float GetY() { return mY; }
+		float GetZ() { return mZ; }
+
+		void SetX(const float fX) { mX = fX; }
+		void SetY(const float fY) { mY = fY; }
+		void SetZ(const float fZ) { mZ = fZ; }
+		void SetPosition(const float fX, const float fY) { mX = fX; mY = fY; }
+
+		void MoveX(const float fX) { mX += fX; }
+		void MoveY(const float fY) { mY += fY; }
+		void MoveZ(const float fZ) { mZ += fZ; }
+		void Move(const float fX, const float fY) { mX += fX; mY += fY; }
+	};
+}
\ No newline at end of file
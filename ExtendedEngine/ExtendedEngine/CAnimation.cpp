@@ -1,166 +1,439 @@
 #include "stdafx.h"
 #include "CAnimation.h"
 #include "ExEngine.h"
+#include <cmath>
 
 namespace tle
 {
-	CAnimation::CAnimation(ExEngine* engine, SpriteVector& sprites, const CVector3& pos, const float rate, const bool looped)
+	//In Streamed mode only the first frame's sprite needs to be set, in SingleSprite mode none are
+	//The depths are the depths the sprites were last given
+	CAnimation::CAnimation(ExEngine* engine, CAnimationClock* clock, CFrameSet* frameSet, SpriteVector& sprites, std::vector<float>& depths, const CVector3& pos,
+							const float rate, const bool looped, const EAnimationMode mode)
 	{
 		mPos = pos;
 
 		mPaused = false;
 		mLooped = looped;
 		mHasEnded = false;
+		mCulled = false;
 
 		mAnimationRate = rate;
-		mTimePassed = 0.0f;
+		mClock = clock;
+		mClockGroup = -1;
+		mClockSlot = -1;
 
+		mSprites = sprites;
 		mSize = static_cast<int>(mSprites.size());
 		mIndex = 0;
-		mSprites = sprites;
+		mMode = mode;
+		mFrameSet = frameSet;
+		if (mMode == Streamed) mPrefetched.resize(mSize, false);
+		mStreamStart = 0;
+
+		mSpriteDepths = depths;
+		mSpriteDepths.resize(mSize, 0.0f);
+
+		mParent = 0;
+		mParentPlaced = false;
+		mAttachSlot = -1;
+		for (int i = 0; i < 16; ++i)
+		{
+			mParentMatrix[i] = 0.0f;
+		}
 
 		mEngine = engine;
 
-		//Set the first sprite on screen
-		if (mIndex < mSize) //Check if there is sprites within the vector
+		//Only the first frame is loaded, the files of the frames after it start being read in the background
+		if (mMode == Streamed) StreamFrames();
+
+		//Enough sprites of every frame are parked for the animation up front so changing frame never loads one
+		if (mMode == SingleSprite)
 		{
-			mSprites[mIndex]->SetPosition(mPos.x, mPos.y);
-			mIndex++;
+			mFrameSet->AddBorrower();
+			if (mSize) mSprites[0] = mFrameSet->BorrowSprite(0, mSpriteDepths[0]);
 		}
 
-		//Move all other sprites off screen
-		for (; mIndex < mSize; mIndex++)
+		//Set the first sprite on screen, the rest are already parked off screen by the frame set
+		PlaceShownSprite();
+
+		UpdateCulling();
+		UpdateClock();
+	}
+
+	//Moves the shown frame off screen and puts the frame at the index on screen
+	//While culled only the index is changed, the sprite is put on screen when the animation is unculled
+	void CAnimation::ShowFrame(int index)
+	{
+		if (index == mIndex) return;
+		if (mCulled)
 		{
-			mSprites[mIndex]->SetPosition(static_cast<float>(mEngine->GetWidth()),
-				static_cast<float>(mEngine->GetHeight()));
+			mIndex = index;
+			return;
 		}
-		mIndex = 0;
+
+		if (mMode == SingleSprite)
+		{
+			//Hand the sprite back to the frame set, which parks it off screen, and borrow one of the next frame
+			//The frame set always has one parked so no sprite is loaded or removed
+			if (mSprites[mIndex])
+			{
+				mFrameSet->ParkSprite(mIndex, mSprites[mIndex], mSpriteDepths[mIndex]);
+				mSprites[mIndex] = 0;
+			}
+			mIndex = index;
+			mSprites[mIndex] = mFrameSet->BorrowSprite(mIndex, mSpriteDepths[mIndex]);
+			PlaceShownSprite();
+			return;
+		}
+
+		if (mMode == Streamed)
+		{
+			if (mSprites[mIndex])
+			{
+				mSprites[mIndex]->SetPosition(static_cast<float>(mEngine->GetWidth()),
+					static_cast<float>(mEngine->GetHeight()));
+			}
+			mIndex = index;
+			StreamFrames();
+			FillStreamWindow();
+			PlaceShownSprite();
+			return;
+		}
+
+		//Remove the previous sprite
+		mSprites[mIndex]->SetPosition(static_cast<float>(mEngine->GetWidth()),
+			static_cast<float>(mEngine->GetHeight()));
+
+		//Place next sprite on screen
+		mIndex = index;
+		PlaceShownSprite();
+	}
+
+	//Returns the frame the number of frames after the start frame, wrapping if looped
+	//Returns -1 if the animation isn't looped and the frame is past the end, or if there are no frames
+	int CAnimation::GetFrameAhead(int start, int ahead)
+	{
+		if (!mSize) return -1;
+		int frame = start + ahead;
+		if (frame < mSize) return frame;
+		return mLooped ? frame % mSize : -1;
 	}
 
-	//Move the animation frames along by the set amount of time
-	void CAnimation::Update(float delta)
+	//Returns true if the frame is within the stream window of the shown frame
+	bool CAnimation::IsInStreamWindow(int frame)
+	{
+		int ahead = frame - mIndex;
+		if (mLooped && ahead < 0) ahead += mSize;
+		return ahead >= 0 && ahead < kStreamWindow;
+	}
+
+	//Removes the sprites of frames that have left the stream window since it was last loaded,
+	//loads the shown frame if it isn't loaded yet and prefetches the frames after it
+	//Only the frames around the two windows are visited so the cost doesn't grow with the length of the animation
+	void CAnimation::StreamFrames()
 	{
-		//Don't Animate if it is not looped and has already reached the end
-		if (!mLooped && mIndex == mSize) return;
-		//Don't Animate if there is not sprites in the vector, so I can assume for the rest of the code that there is at least one sprite
-		//It's also a small optimization due to less checks needed to make it robust
 		if (!mSize) return;
-		if (mPaused) return;
 
-		//Increment timer
-		mTimePassed += delta;
-		//For each tick of the animation that has passed since the last call
-		while (mTimePassed > mAnimationRate)
+		//Frames left behind are removed rather than parked so memory stays bounded by the window
+		for (int i = 0; i < kStreamWindow; ++i)
 		{
-			//Remove the previous sprite
-			mSprites[mIndex]->SetPosition(static_cast<float>(mEngine->GetWidth()),
-				static_cast<float>(mEngine->GetHeight()));
+			int frame = GetFrameAhead(mStreamStart, i);
+			if (frame < 0) break;
+			if (mSprites[frame] && !IsInStreamWindow(frame))
+			{
+				mFrameSet->RemoveSprite(frame, mSprites[frame]);
+				mSprites[frame] = 0;
+				mPrefetched[frame] = false;
+			}
+		}
+		mStreamStart = mIndex;
+
+		//The shown frame is only missing if the animation has skipped past the frames loaded ahead of it
+		if (!mSprites[mIndex]) mSprites[mIndex] = mFrameSet->TakeSprite(mIndex, mSpriteDepths[mIndex]);
+
+		//Read the files of the frames after the shown frame in the background
+		for (int i = 1; i < 2 * kStreamWindow; ++i)
+		{
+			int frame = GetFrameAhead(mIndex, i);
+			if (frame < 0) break;
+			if (!mSprites[frame] && !mPrefetched[frame])
+			{
+				mFrameSet->Prefetch(frame);
+				mPrefetched[frame] = true;
+			}
+		}
+	}
 
-			//Increment sprite pointer
-			mIndex++;
-			if (mIndex == mSize)
+	//Loads the nearest frame of the stream window that isn't loaded yet
+	//Only one frame is loaded each time the frame changes, which keeps up with a window that moves a frame at a time
+	void CAnimation::FillStreamWindow()
+	{
+		for (int i = 1; i < kStreamWindow; ++i)
+		{
+			int frame = GetFrameAhead(mIndex, i);
+			if (frame < 0) return;
+			if (!mSprites[frame])
 			{
-				if (mLooped) //Loop back to the start
-				{
-					mIndex = 0;
-				}
-				else //Revert back to the last available sprite
-				{
-					mIndex--;
-					mHasEnded = true;
-				}
+				//Its file has usually been read in the background by now
+				mSprites[frame] = mFrameSet->TakeSprite(frame, mSpriteDepths[frame]);
+				return;
 			}
+		}
+	}
+
+	//Returns the sprite being shown, or null if there isn't one
+	ISprite* CAnimation::GetShownSprite()
+	{
+		if (!mCulled && mIndex < mSize) return mSprites[mIndex];
+		return 0;
+	}
+
+	//Puts the shown sprite at the animation's position
+	//Its depth is only set if the sprite doesn't already have the animation's depth
+	void CAnimation::PlaceShownSprite()
+	{
+		ISprite* sprite = GetShownSprite();
+		if (!sprite) return;
+
+		if (mSpriteDepths[mIndex] != mPos.z)
+		{
+			sprite->SetZ(mPos.z);
+			mSpriteDepths[mIndex] = mPos.z;
+		}
+		sprite->SetPosition(mPos.x, mPos.y);
+	}
+
+	//Culls or unculls the animation at its new position and moves the shown sprite to it
+	void CAnimation::ApplyPosition()
+	{
+		bool wasCulled = mCulled;
+		UpdateCulling();
+
+		//Unculling has already placed the sprite and a culled animation has no sprite to move
+		if (!wasCulled) PlaceShownSprite();
+	}
+
+	//Culls the animation if its position is outside the view and unculls it if it has come back in
+	//Sprites are positioned by their top left corner so the margin only applies to the left and top edges,
+	//a negative margin turns culling off
+	void CAnimation::UpdateCulling()
+	{
+		const float margin = mEngine->GetAnimationCullMargin();
+		bool outside = margin >= 0.0f &&
+			(mPos.x >= static_cast<float>(mEngine->GetWidth()) || mPos.y >= static_cast<float>(mEngine->GetHeight()) ||
+			mPos.x <= -margin || mPos.y <= -margin);
+
+		if (outside && !mCulled)
+		{
+			Cull();
+		}
+		else if (!outside && mCulled)
+		{
+			Uncull();
+		}
+	}
 
-			//Place next sprite on screen
-			mSprites[mIndex]->SetPosition(mPos.x, mPos.y);
+	//Takes the shown sprite off screen, until the animation is unculled only its frame index moves on
+	void CAnimation::Cull()
+	{
+		ISprite* sprite = GetShownSprite();
+		mCulled = true;
+		if (!sprite) return;
 
-			//Decrement timer
-			mTimePassed -= mAnimationRate;
+		//A single sprite animation has no need to hold on to a sprite it isn't showing
+		if (mMode == SingleSprite)
+		{
+			mFrameSet->ParkSprite(mIndex, sprite, mSpriteDepths[mIndex]);
+			mSprites[mIndex] = 0;
+			return;
 		}
+
+		sprite->SetPosition(static_cast<float>(mEngine->GetWidth()),
+			static_cast<float>(mEngine->GetHeight()));
+	}
+
+	//Puts the sprite of the frame the animation has reached on screen
+	void CAnimation::Uncull()
+	{
+		mCulled = false;
+		if (!mSize) return;
+
+		if (mMode == SingleSprite && !mSprites[mIndex])
+		{
+			mSprites[mIndex] = mFrameSet->BorrowSprite(mIndex, mSpriteDepths[mIndex]);
+		}
+		else if (mMode == Streamed)
+		{
+			StreamFrames();
+			FillStreamWindow();
+		}
+
+		PlaceShownSprite();
+	}
+
+	//Moves the animation on by a number of ticks, only the sprites of the old and new frames are touched
+	//Kept as a float so any number of ticks can be skipped without overflowing
+	//Called by the clock, which works out how many ticks have passed once for every animation of the same rate
+	void CAnimation::AdvanceFrames(float ticks)
+	{
+		int next;
+		if (mLooped) //Wrap around as many times as needed
+		{
+			next = (mIndex + static_cast<int>(fmodf(ticks, static_cast<float>(mSize)))) % mSize;
+		}
+		else if (ticks >= static_cast<float>(mSize - mIndex)) //Stay on the last available sprite
+		{
+			next = mSize - 1;
+			mHasEnded = true;
+		}
+		else
+		{
+			next = mIndex + static_cast<int>(ticks);
+		}
+		ShowFrame(next);
+	}
+
+	//Puts the animation on the clock if it is running and takes it off if it is paused or has ended
+	//Animations without sprites have nothing to show so are never put on the clock
+	void CAnimation::UpdateClock()
+	{
+		if (!mPaused && !mHasEnded && mSize)
+		{
+			mClock->Add(this);
+		}
+		else
+		{
+			mClock->Remove(this);
+		}
+	}
+
+	//Moves the animation to where its parent is on screen
+	//Does nothing if neither the parent nor the camera has moved since it was last placed
+	//Called by the engine when the scene is drawn, a parent behind the camera puts the animation off screen
+	void CAnimation::FollowParent(bool cameraMoved)
+	{
+		float matrix[16];
+		mParent->GetMatrix(matrix);
+
+		bool parentMoved = !mParentPlaced;
+		for (int i = 0; i < 16; ++i)
+		{
+			if (matrix[i] != mParentMatrix[i])
+			{
+				parentMoved = true;
+				mParentMatrix[i] = matrix[i];
+			}
+		}
+		if (!parentMoved && !cameraMoved) return;
+		mParentPlaced = true;
+
+		//The offset turns with the parent
+		CVector3 position(matrix[12], matrix[13], matrix[14]);
+		position.x += matrix[0] * mParentOffset.x + matrix[4] * mParentOffset.y + matrix[8] * mParentOffset.z;
+		position.y += matrix[1] * mParentOffset.x + matrix[5] * mParentOffset.y + matrix[9] * mParentOffset.z;
+		position.z += matrix[2] * mParentOffset.x + matrix[6] * mParentOffset.y + matrix[10] * mParentOffset.z;
+
+		if (!mEngine->ProjectToScreen(position, mPos.x, mPos.y))
+		{
+			mPos.x = static_cast<float>(mEngine->GetWidth());
+			mPos.y = static_cast<float>(mEngine->GetHeight());
+		}
+		ApplyPosition();
+	}
+
+	//Plays the animation again from the start at the position with the tick rate
+	//Used to reuse finished one shot animations
+	void CAnimation::Restart(const CVector3& pos, const float rate)
+	{
+		//The rate decides which group of the clock the animation is in
+		mClock->Remove(this);
+		mAnimationRate = rate;
+		mPaused = false;
+		Reset();
+		SetPosition(pos);
+	}
+
+	//Moves the shown sprite off screen while the animation waits in its frame set's pool
+	void CAnimation::Park()
+	{
+		ISprite* sprite = GetShownSprite();
+		if (sprite)
+		{
+			sprite->SetPosition(static_cast<float>(mEngine->GetWidth()),
+				static_cast<float>(mEngine->GetHeight()));
+		}
+	}
+
+	//Returns the frame set the animation's sprites come from
+	CFrameSet* CAnimation::GetFrameSet()
+	{
+		return mFrameSet;
 	}
 
 	//Starts the animation
 	void CAnimation::Run()
 	{
 		mPaused = false;
+		UpdateClock();
 	}
 
 	//Pauses the animation
 	void CAnimation::Pause()
 	{
 		mPaused = true;
+		UpdateClock();
 	}
 
 	//Reset the animation to the start
 	void CAnimation::Reset()
 	{
-		mTimePassed = 0.0f;
 		mHasEnded = false;
 
 		//Check if there are sprites
 		if (mSize)
 		{
-			//Move the previous sprite off screen
-			mSprites[mIndex]->SetPosition(static_cast<float>(mEngine->GetWidth()),
-				static_cast<float>(mEngine->GetHeight()));
-
 			//Move back to the start
-			mIndex = 0;
-
-			//Place the current sprite on screen
-			mSprites[mIndex]->SetPosition(mPos.x, mPos.y);
+			ShowFrame(0);
 		}
+		UpdateClock();
 	}
 
 	//Set the x position of the animation
 	void CAnimation::SetX(float x)
 	{
 		mPos.x = x;
-		//Update the current sprite if one exists
-		if (mIndex < mSize)
-		{
-			mSprites[mIndex]->SetX(mPos.x);
-		}
+		ApplyPosition();
 	}
 
 	//Set the y position of the animation
 	void CAnimation::SetY(float y)
 	{
 		mPos.y = y;
-		//Update the current sprite if one exists
-		if (mIndex < mSize)
-		{
-			mSprites[mIndex]->SetY(mPos.y);
-		}
+		ApplyPosition();
 	}
 
 	//Set the z position of the animation
+	//Only the shown sprite is given the depth, the others are given it when they are next shown
 	void CAnimation::SetZ(float z)
 	{
+		if (z == mPos.z) return;
+
 		mPos.z = z;
-		//Update all sprites in the vector
-		for (auto it = mSprites.begin(); it != mSprites.end(); it++)
+
+		ISprite* sprite = GetShownSprite();
+		if (sprite)
 		{
-			(*it)->SetZ(mPos.z);
+			sprite->SetZ(mPos.z);
+			mSpriteDepths[mIndex] = mPos.z;
 		}
 	}
 
 	//Set the x, y and z position of the animation
+	//Only the shown sprite is moved, the others are given the depth when they are next shown
 	void CAnimation::SetPosition(const CVector3& pos)
 	{
 		mPos = pos;
-
-		//Update the current sprite if one exist
-		if (mIndex < mSize)
-		{
-			mSprites[mIndex]->SetPosition(mPos.x, mPos.y);
-		}
-
-		//Update all sprites in the vector
-		for (auto it = mSprites.begin(); it != mSprites.end(); it++)
-		{
-			(*it)->SetZ(mPos.z);
-		}
+		ApplyPosition();
 	}
 
 	//Return the x position of the animation
@@ -205,24 +478,20 @@ namespace tle
 		return mLooped;
 	}
 
+	//Returns whether the animation holds every frame or only the one being shown
+	EAnimationMode CAnimation::GetMode()
+	{
+		return mMode;
+	}
+
 	void CAnimation::MoveX(float xMovement)
 	{
-		mPos.x += xMovement;
-		//Update the current sprite if one exists
-		if (mIndex < mSize)
-		{
-			mSprites[mIndex]->SetX(mPos.x);
-		}
+		SetX(mPos.x + xMovement);
 	}
 
 	void CAnimation::MoveY(float yMovement)
 	{
-		mPos.y += yMovement;
-		//Update the current sprite if one exists
-		if (mIndex < mSize)
-		{
-			mSprites[mIndex]->SetY(mPos.y);
-		}
+		SetY(mPos.y + yMovement);
 	}
 
 	void CAnimation::MoveZ(float zMovement)
@@ -232,27 +501,73 @@ namespace tle
 
 	void CAnimation::Move(const CVector3& movement)
 	{
-		mPos = movement;
+		SetPosition(mPos + movement);
+	}
 
-		//Update the current sprite if one exist
-		if (mIndex < mSize)
-		{
-			mSprites[mIndex]->SetPosition(mPos.x, mPos.y);
-		}
+	//Makes the animation follow the scene node on screen, the offset is relative to the node and turns with it
+	//The engine places the animation when the scene is next drawn
+	void CAnimation::AttachTo(ISceneNode* parent, const CVector3& offset)
+	{
+		mParent = parent;
+		mParentOffset = offset;
+		mParentPlaced = false;
+		mEngine->AttachAnimation(this);
+	}
+
+	//Stops the animation following the scene node, it stays where it was last placed
+	void CAnimation::Detach()
+	{
+		mEngine->DetachAnimation(this);
+		mParent = 0;
+	}
 
-		//Update all sprites in the vector
+	//Returns the number of sprites owned by the animation
+	int CAnimation::GetSpriteCount()
+	{
+		if (mMode == AllFrames) return static_cast<int>(mSprites.size());
+
+		int count = 0;
 		for (auto it = mSprites.begin(); it != mSprites.end(); it++)
 		{
-			(*it)->SetZ(mPos.z);
+			if (*it) ++count;
 		}
+		return count;
+	}
+
+	//Returns an estimate of the memory held by the animation in bytes
+	size_t CAnimation::GetMemoryUsage()
+	{
+		return sizeof(CAnimation) + mSprites.capacity() * sizeof(ISprite*) + mPrefetched.capacity() / 8 +
+			mSpriteDepths.capacity() * sizeof(float);
 	}
 
 	CAnimation::~CAnimation()
 	{
-		//Remove all sprites from the scene
-		for (auto it = mSprites.begin(); it != mSprites.end(); it++)
+		mClock->Remove(this);
+		mEngine->DetachAnimation(this);
+
+		//Streamed animations are too long to keep the frames of so remove them
+		if (mMode == Streamed)
+		{
+			for (int frame = 0; frame < mSize; ++frame)
+			{
+				if (mSprites[frame]) mFrameSet->RemoveSprite(frame, mSprites[frame]);
+			}
+			mSprites.clear();
+		}
+
+		//Hand back the borrowed sprite, the frame set keeps it parked until the animation is no longer counted
+		if (mMode == SingleSprite)
 		{
-			mEngine->RemoveSprite(*it);
+			if (mSize)
+			{
+				if (mSprites[mIndex]) mFrameSet->ParkSprite(mIndex, mSprites[mIndex], mSpriteDepths[mIndex]);
+				mSprites[mIndex] = 0;
+			}
+			mFrameSet->RemoveBorrower();
 		}
+
+		//Park the sprites for the next animation of the frame set
+		mFrameSet->ReturnSprites(mSprites, mSpriteDepths);
 	}
 }
\ No newline at end of file
@@ -1,37 +1,118 @@
 #pragma once
 #include <vector>
 #include "IAnimation.h"
-#include "Sprite.h"
+#include "CFrameSet.h"
+#include "CAnimationClock.h"
 
 namespace tle
 {
 	//Hacky work around to avoid circular reference
 	class ExEngine;
 
-	using SpriteVector = std::vector<ISprite*>;
-
 	class CAnimation : public IAnimation
 	{
 	private:
+		//Number of frames from the one shown that a streamed animation keeps loaded once it has been playing for a while
+		//It starts with only the first frame and loads one more each time the frame changes
+		//The files of the frames up to a window past them are read in the background
+		static const int kStreamWindow = 8;
+
 		CVector3 mPos;
 
 		bool mPaused;
 		bool mLooped;
 		bool mHasEnded;
+		bool mCulled; //Outside the view, only the frame index moves on and no sprite is shown
 
 		float mAnimationRate;
-		float mTimePassed;
+
+		//The clock that ticks the animation while it is running, the group and slot are -1 while it isn't on the clock
+		CAnimationClock* mClock;
+		int mClockGroup;
+		int mClockSlot;
+		friend class CAnimationClock;
 
 		int mSize;
 		int mIndex;
-		SpriteVector mSprites;
+		EAnimationMode mMode;
+		SpriteVector mSprites; //Taken from the frame set and handed back when the animation is destroyed, only the shown frame is set in SingleSprite mode
+		CFrameSet* mFrameSet;
+		std::vector<bool> mPrefetched; //Frames of a streamed animation whose files have been asked to be read
+		int mStreamStart; //First frame of the stream window that is loaded
+
+		//Sprites are only given the animation's depth when they are shown, and only if their depth differs
+		//Sprites from the frame set come with the depth they were last given
+		std::vector<float> mSpriteDepths;
+
+		//Scene node the animation follows on screen, null if it isn't attached
+		ISceneNode* mParent;
+		CVector3 mParentOffset;
+		float mParentMatrix[16]; //Matrix of the parent when the animation was last placed
+		bool mParentPlaced; //False until the animation has been placed for its parent
+		int mAttachSlot; //Slot in the engine's list of attached animations, -1 if not attached
+		friend class ExEngine;
 
 		ExEngine* mEngine;
 
+		//Moves the shown frame off screen and puts the frame at the index on screen
+		void ShowFrame(int index);
+
+		//Returns the sprite being shown, or null if there isn't one
+		ISprite* GetShownSprite();
+
+		//Puts the shown sprite at the animation's position
+		//Its depth is only set if the depth has changed since the sprite was last shown
+		void PlaceShownSprite();
+
+		//Culls or unculls the animation at its new position and moves the shown sprite to it
+		void ApplyPosition();
+
+		//Moves the animation on by a number of ticks, only the sprites of the old and new frames are touched
+		void AdvanceFrames(float ticks);
+
+		//Returns the frame the number of frames after the shown frame, wrapping if looped
+		//Returns -1 if the animation isn't looped and the frame is past the end
+		int GetFrameAhead(int start, int ahead);
+
+		//Returns true if the frame is within the stream window of the shown frame
+		bool IsInStreamWindow(int frame);
+
+		//Removes the sprites of frames that have left the stream window since it was last loaded,
+		//loads the shown frame if it isn't loaded yet and prefetches the frames after it
+		void StreamFrames();
+
+		//Loads the nearest frame of the stream window that isn't loaded yet
+		void FillStreamWindow();
+
+		//Takes the shown sprite off screen, until the animation is unculled only its frame index moves on
+		void Cull();
+
+		//Puts the sprite of the frame the animation has reached on screen
+		void Uncull();
+
+		//Puts the animation on the clock if it is running and takes it off if it is paused or has ended
+		void UpdateClock();
+
 	public:
-		CAnimation(ExEngine* engine, SpriteVector& sprites, const CVector3& pos, const float rate, const bool looped);
+		CAnimation(ExEngine* engine, CAnimationClock* clock, CFrameSet* frameSet, SpriteVector& sprites, std::vector<float>& depths, const CVector3& pos,
+					const float rate, const bool looped, const EAnimationMode mode);
+
+		//Plays the animation again from the start at the position with the tick rate
+		//Used to reuse finished one shot animations
+		void Restart(const CVector3& pos, const float rate);
+
+		//Moves the shown sprite off screen while the animation waits in its frame set's pool
+		void Park();
 
-		virtual void Update(float delta);
+		//Returns the frame set the animation's sprites come from
+		CFrameSet* GetFrameSet();
+
+		//Culls the animation if its position is outside the view and unculls it if it has come back in
+		void UpdateCulling();
+
+		//Moves the animation to where its parent is on screen
+		//Does nothing if neither the parent nor the camera has moved since it was last placed
+		void FollowParent(bool cameraMoved);
 
 		virtual void Run();
 		virtual void Pause();
@@ -52,12 +133,22 @@ namespace tle
 		virtual bool IsPaused();
 		virtual bool IsLooped();
 		virtual bool HasEnded();
+		virtual EAnimationMode GetMode();
 
 		virtual void MoveX(float xMovement);
 		virtual void MoveY(float yMovement);
 		virtual void MoveZ(float zMovement);
 		virtual void Move(const CVector3& movement);
 
+		virtual void AttachTo(ISceneNode* parent, const CVector3& offset = CVector3(0.0f, 0.0f, 0.0f));
+		virtual void Detach();
+
+		//Returns the number of sprites owned by the animation
+		int GetSpriteCount();
+
+		//Returns an estimate of the memory held by the animation in bytes
+		size_t GetMemoryUsage();
+
 		~CAnimation();
 	};
 }
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "stdafx.h"
+#include "CAnimationClock.h"
+#include "CAnimation.h"
+#include <cmath>
+
+namespace tle
+{
+	//Starts ticking the animation with the other animations of its rate
+	//Does nothing if the animation is already on the clock
+	void CAnimationClock::Add(CAnimation* animation)
+	{
+		if (animation->mClockGroup >= 0) return;
+
+		int group = 0;
+		while (group < static_cast<int>(mGroups.size()) && mGroups[group].mRate != animation->mAnimationRate) ++group;
+		if (group == static_cast<int>(mGroups.size()))
+		{
+			SRateGroup newGroup;
+			newGroup.mRate = animation->mAnimationRate;
+			newGroup.mTimePassed = 0.0f;
+			mGroups.push_back(newGroup);
+		}
+
+		animation->mClockGroup = group;
+		animation->mClockSlot = static_cast<int>(mGroups[group].mAnimations.size());
+		mGroups[group].mAnimations.push_back(animation);
+	}
+
+	//Stops ticking the animation
+	//Does nothing if the animation isn't on the clock
+	void CAnimationClock::Remove(CAnimation* animation)
+	{
+		if (animation->mClockGroup < 0) return;
+
+		RemoveAt(animation->mClockGroup, animation->mClockSlot);
+	}
+
+	//Removes the animation at the slot of the group by swapping the last animation into it
+	void CAnimationClock::RemoveAt(int group, int slot)
+	{
+		std::vector<CAnimation*>& animations = mGroups[group].mAnimations;
+		animations[slot]->mClockGroup = -1;
+
+		CAnimation* last = animations.back();
+		animations[slot] = last;
+		last->mClockSlot = slot;
+		animations.pop_back();
+	}
+
+	//Moves every running animation on by the time passed
+	void CAnimationClock::Update(float delta)
+	{
+		mFinished.clear();
+
+		for (int group = 0; group < static_cast<int>(mGroups.size()); ++group)
+		{
+			SRateGroup& rateGroup = mGroups[group];
+
+			//An empty group restarts its timer so the next animation added starts on a whole tick
+			if (rateGroup.mAnimations.empty())
+			{
+				rateGroup.mTimePassed = 0.0f;
+				continue;
+			}
+			if (rateGroup.mRate <= 0.0f) continue;
+
+			rateGroup.mTimePassed += delta;
+			if (rateGroup.mTimePassed <= rateGroup.mRate) continue;
+
+			float ticks = floorf(rateGroup.mTimePassed / rateGroup.mRate);
+			rateGroup.mTimePassed -= ticks * rateGroup.mRate;
+
+			for (int slot = 0; slot < static_cast<int>(rateGroup.mAnimations.size()); /*Only increment if no removal occurs*/)
+			{
+				CAnimation* animation = rateGroup.mAnimations[slot];
+				animation->AdvanceFrames(ticks);
+
+				//Finished animations drop off the clock until they are reset
+				if (animation->mHasEnded)
+				{
+					mFinished.push_back(animation);
+					RemoveAt(group, slot);
+					continue;
+				}
+				++slot;
+			}
+		}
+	}
+
+	//Returns the animations that reached their end during the last update
+	//Only valid until the next update or until one of the animations is destroyed
+	const std::vector<CAnimation*>& CAnimationClock::GetFinishedAnimations()
+	{
+		return mFinished;
+	}
+
+	//Returns the number of running animations
+	int CAnimationClock::GetAnimationCount()
+	{
+		int count = 0;
+		for (auto group = mGroups.begin(); group != mGroups.end(); ++group)
+		{
+			count += static_cast<int>(group->mAnimations.size());
+		}
+		return count;
+	}
+
+	//Returns an estimate of the memory held by the clock in bytes
+	size_t CAnimationClock::GetMemoryUsage()
+	{
+		size_t bytes = sizeof(CAnimationClock) + mGroups.capacity() * sizeof(SRateGroup) + mFinished.capacity() * sizeof(CAnimation*);
+		for (auto group = mGroups.begin(); group != mGroups.end(); ++group)
+		{
+			bytes += group->mAnimations.capacity() * sizeof(CAnimation*);
+		}
+		return bytes;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+#include "IUsings.h"
+
+namespace tle
+{
+	class CAnimation;
+
+	//Drives every running animation from one timer for each tick rate
+	//How many ticks have passed is worked out once for each rate and applied to its animations in a single pass
+	//Only animations that are running are held, paused and ended animations aren't visited at all
+	class CAnimationClock
+	{
+	private:
+		struct SRateGroup
+		{
+			float mRate;
+			float mTimePassed;
+			std::vector<CAnimation*> mAnimations; //Unordered, removed by swapping with the last
+		};
+
+		//Groups are never removed as there are only ever a handful of different rates
+		std::vector<SRateGroup> mGroups;
+
+		//Animations that reached their end during the last update
+		std::vector<CAnimation*> mFinished;
+
+		//Removes the animation at the slot of the group by swapping the last animation into it
+		void RemoveAt(int group, int slot);
+
+	public:
+		//Starts ticking the animation with the other animations of its rate
+		//Does nothing if the animation is already on the clock
+		void Add(CAnimation* animation);
+
+		//Stops ticking the animation
+		//Does nothing if the animation isn't on the clock
+		void Remove(CAnimation* animation);
+
+		//Moves every running animation on by the time passed
+		void Update(float delta);
+
+		//Returns the animations that reached their end during the last update
+		//Only valid until the next update or until one of the animations is destroyed
+		const std::vector<CAnimation*>& GetFinishedAnimations();
+
+		//Returns the number of running animations
+		int GetAnimationCount();
+
+		//Returns an estimate of the memory held by the clock in bytes
+		size_t GetMemoryUsage();
+	};
+}
\ No newline at end of file
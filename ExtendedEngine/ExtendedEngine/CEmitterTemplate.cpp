@@ -0,0 +1,94 @@
+#include "stdafx.h"
+#include "CEmitterTemplate.h"
+#include "ExEngine.h"
+
+namespace tle
+{
+	//Creates the template and its shared particle data
+	CEmitterTemplate::CEmitterTemplate(const SEmitterSettings& settings, ExEngine* engine)
+	{
+		mSettings = settings;
+
+		//Always have at least one texture
+		if (mSettings.mParticleSkin.empty()) mSettings.mParticleSkin.push_back(PARTICLE_TEXTURE);
+
+		mpParticleData = std::make_shared<ParticleData>();
+		mpParticleData->mMaxLife = mSettings.mParticleLife;
+		mpParticleData->mScale = mSettings.mParticleScale;
+		mpParticleData->mAnimationRate = mSettings.mParticleLife / static_cast<int>(mSettings.mParticleSkin.size());
+		mpParticleData->mVel = mSettings.mParticleVelocity;
+		mpParticleData->mAcl = mSettings.mParticleAcceleration;
+		mpParticleData->mFlipbook = mSettings.mParticleFlipbook;
+		mpParticleData->mNumPlanes = 0;
+		mpParticleData->mNumSpheres = 0;
+		mpParticleData->mScaleKeys = mSettings.mParticleScaleCurve;
+		mpParticleData->mDragKeys = mSettings.mParticleDragCurve;
+		BakeCurve(mpParticleData->mScaleKeys, mpParticleData->mScaleCurve);
+		BakeCurve(mpParticleData->mDragKeys, mpParticleData->mDragCurve);
+		for (auto texture = mSettings.mParticleSkin.begin(); texture != mSettings.mParticleSkin.end(); ++texture)
+		{
+			mpParticleData->mTexture.push_back(engine->GetTextureId(*texture));
+		}
+	}
+
+	//Returns the settings the template was created with
+	const SEmitterSettings& CEmitterTemplate::GetSettings()
+	{
+		return mSettings;
+	}
+
+	//Returns the particle data shared by the emitters of the template
+	std::shared_ptr<ParticleData> CEmitterTemplate::GetParticleData()
+	{
+		return mpParticleData;
+	}
+
+	//Returns an idle emitter or null if there are none
+	std::unique_ptr<CParticleEmitter> CEmitterTemplate::TakeIdleEmitter()
+	{
+		if (mIdleEmitters.empty()) return std::unique_ptr<CParticleEmitter>();
+
+		std::unique_ptr<CParticleEmitter> emitter = move(mIdleEmitters.back());
+		mIdleEmitters.pop_back();
+		return emitter;
+	}
+
+	//Takes ownership of the emitter if there is room in the pool
+	//If the pool is full the emitter is left with the caller to be destroyed
+	void CEmitterTemplate::ReturnIdleEmitter(std::unique_ptr<CParticleEmitter>&& emitter)
+	{
+		if (static_cast<int>(mIdleEmitters.size()) >= kMaxIdleEmitters) return;
+
+		emitter->Park();
+		mIdleEmitters.push_back(move(emitter));
+	}
+
+	//Destroys all idle emitters
+	void CEmitterTemplate::ClearIdleEmitters()
+	{
+		mIdleEmitters.clear();
+	}
+
+	//Returns the number of idle emitters
+	int CEmitterTemplate::GetIdleEmitterCount()
+	{
+		return static_cast<int>(mIdleEmitters.size());
+	}
+
+	//Returns an estimate of the memory held by the idle emitters in bytes
+	size_t CEmitterTemplate::GetMemoryUsage()
+	{
+		size_t bytes = sizeof(CEmitterTemplate) + sizeof(ParticleData) + mpParticleData->mTexture.capacity() * sizeof(int);
+		bytes += (mpParticleData->mScaleKeys.capacity() + mpParticleData->mDragKeys.capacity()) * sizeof(float);
+		for (auto emitter = mIdleEmitters.begin(); emitter != mIdleEmitters.end(); ++emitter)
+		{
+			bytes += (*emitter)->GetMemoryUsage();
+		}
+		return bytes;
+	}
+
+	CEmitterTemplate::~CEmitterTemplate()
+	{
+		ClearIdleEmitters();
+	}
+}
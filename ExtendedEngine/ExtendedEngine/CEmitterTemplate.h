@@ -0,0 +1,52 @@
+#pragma once
+#include "IEmitterTemplate.h"
+#include "CParticleEmitter.h"
+
+namespace tle
+{
+	//Hacky work around to avoid circular reference
+	class ExEngine;
+
+	class CEmitterTemplate : public IEmitterTemplate
+	{
+	private:
+		//Most idle emitters kept around at once, any more are destroyed
+		static const int kMaxIdleEmitters = 64;
+
+		SEmitterSettings mSettings;
+
+		//Particle data every emitter of the template points at, never modified after creation
+		std::shared_ptr<ParticleData> mpParticleData;
+
+		//Removed emitters waiting to be spawned again
+		vector_ptr<CParticleEmitter> mIdleEmitters;
+
+	public:
+		//Creates the template and its shared particle data
+		CEmitterTemplate(const SEmitterSettings& settings, ExEngine* engine);
+
+		//Returns the settings the template was created with
+		virtual const SEmitterSettings& GetSettings();
+
+		//Returns the particle data shared by the emitters of the template
+		std::shared_ptr<ParticleData> GetParticleData();
+
+		//Returns an idle emitter or null if there are none
+		std::unique_ptr<CParticleEmitter> TakeIdleEmitter();
+
+		//Takes ownership of the emitter if there is room in the pool
+		//If the pool is full the emitter is left with the caller to be destroyed
+		void ReturnIdleEmitter(std::unique_ptr<CParticleEmitter>&& emitter);
+
+		//Destroys all idle emitters
+		void ClearIdleEmitters();
+
+		//Returns the number of idle emitters
+		int GetIdleEmitterCount();
+
+		//Returns an estimate of the memory held by the idle emitters in bytes
+		size_t GetMemoryUsage();
+
+		virtual ~CEmitterTemplate();
+	};
+}
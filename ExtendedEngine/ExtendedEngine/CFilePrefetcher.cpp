@@ -0,0 +1,98 @@
+#include "stdafx.h"
+#include "CFilePrefetcher.h"
+#include <fstream>
+#include <algorithm>
+
+namespace tle
+{
+	CFilePrefetcher::CFilePrefetcher()
+	{
+		mQuit = false;
+	}
+
+	//Adds a folder to look for files in
+	void CFilePrefetcher::AddFolder(const std::string& folder)
+	{
+		std::lock_guard<std::mutex> lock(mLock);
+		mFolders.push_back(folder);
+	}
+
+	//Removes a folder files are looked for in
+	void CFilePrefetcher::RemoveFolder(const std::string& folder)
+	{
+		std::lock_guard<std::mutex> lock(mLock);
+		auto it = std::find(mFolders.begin(), mFolders.end(), folder);
+		if (it != mFolders.end()) mFolders.erase(it);
+	}
+
+	//Removes all folders, files are then only looked for relative to the working directory
+	void CFilePrefetcher::ClearFolders()
+	{
+		std::lock_guard<std::mutex> lock(mLock);
+		mFolders.clear();
+	}
+
+	//Queues the file to be read in the background
+	void CFilePrefetcher::Prefetch(const std::string& file)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mLock);
+			if (static_cast<int>(mFiles.size()) >= kMaxQueuedFiles) mFiles.pop_front();
+			mFiles.push_back(file);
+		}
+
+		if (!mThread.joinable()) mThread = std::thread(&CFilePrefetcher::WorkerLoop, this);
+		mWake.notify_one();
+	}
+
+	//Reads files until the prefetcher is destroyed
+	void CFilePrefetcher::WorkerLoop()
+	{
+		while (true)
+		{
+			std::string file;
+			std::vector<std::string> folders;
+			{
+				std::unique_lock<std::mutex> lock(mLock);
+				mWake.wait(lock, [this]() { return mQuit || !mFiles.empty(); });
+				if (mQuit) return;
+
+				file = mFiles.front();
+				mFiles.pop_front();
+				folders = mFolders;
+			}
+
+			ReadFile(file, folders);
+		}
+	}
+
+	//Reads the file from the first folder it is found in
+	void CFilePrefetcher::ReadFile(const std::string& file, const std::vector<std::string>& folders)
+	{
+		std::ifstream stream(file, std::ios::binary);
+		for (auto folder = folders.begin(); folder != folders.end() && !stream.is_open(); ++folder)
+		{
+			std::string path = *folder;
+			if (!path.empty() && path.back() != '/' && path.back() != '\\') path += '/';
+			stream.open(path + file, std::ios::binary);
+		}
+		if (!stream.is_open()) return;
+
+		//Only reading matters, the bytes are thrown away
+		//The last partial block is still read before the stream fails
+		char buffer[16384];
+		while (stream.read(buffer, sizeof(buffer)))
+		{
+		}
+	}
+
+	CFilePrefetcher::~CFilePrefetcher()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mLock);
+			mQuit = true;
+		}
+		mWake.notify_all();
+		if (mThread.joinable()) mThread.join();
+	}
+}
\ No newline at end of file
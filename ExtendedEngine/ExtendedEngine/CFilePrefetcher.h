@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "IUsings.h"
+
+namespace tle
+{
+	//Reads files on a background thread ahead of them being loaded by the TL-Engine
+	//The TL-Engine can only load images on the main thread straight from disk, so the bytes read here are thrown away,
+	//what it buys is the file being in the operating system's cache by the time the main thread loads it
+	class CFilePrefetcher
+	{
+	private:
+		//Most files waiting to be read, the oldest requests are dropped as they are the most likely to be needed already
+		static const int kMaxQueuedFiles = 64;
+
+		std::thread mThread; //Only started on the first request
+		std::mutex mLock;
+		std::condition_variable mWake;
+		std::deque<std::string> mFiles;
+		std::vector<std::string> mFolders; //Media folders the files are searched for in, same as the TL-Engine
+		bool mQuit;
+
+		//Reads files until the prefetcher is destroyed
+		void WorkerLoop();
+
+		//Reads the file from the first folder it is found in
+		void ReadFile(const std::string& file, const std::vector<std::string>& folders);
+
+	public:
+		CFilePrefetcher();
+
+		//Adds a folder to look for files in
+		void AddFolder(const std::string& folder);
+
+		//Removes a folder files are looked for in
+		void RemoveFolder(const std::string& folder);
+
+		//Removes all folders, files are then only looked for relative to the working directory
+		void ClearFolders();
+
+		//Queues the file to be read in the background
+		void Prefetch(const std::string& file);
+
+		~CFilePrefetcher();
+	};
+}
\ No newline at end of file
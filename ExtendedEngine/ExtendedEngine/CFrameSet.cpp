@@ -0,0 +1,311 @@
+#include "stdafx.h"
+#include "CFrameSet.h"
+#include "CAnimation.h"
+#include "ExEngine.h"
+#include <iostream>
+
+namespace tle
+{
+	//Creates an empty frame set, no images are loaded until sprites are taken
+	CFrameSet::CFrameSet(ExEngine* engine, const std::vector<string>& frames)
+	{
+		mFrames = frames;
+		mLoaded = false;
+		mIdleSprites.resize(mFrames.size());
+		mIdleSpriteCount = 0;
+		mSpriteCounts.resize(mFrames.size(), 0);
+		mPreloaded = 0;
+		mBorrowers = 0;
+		mBorrowed.resize(mFrames.size(), 0);
+		mpEngine = engine;
+	}
+
+	//Makes sure every frame can be loaded, only loads the images the first time it is called
+	//Returns false if any frame could not be loaded
+	bool CFrameSet::Load()
+	{
+		if (mLoaded) return true;
+
+		//The loaded sprites are parked for the animations that follow
+		SpriteVector sprites;
+		std::vector<float> depths;
+		if (!TakeSprites(sprites, depths)) return false;
+		ReturnSprites(sprites, depths);
+
+		mLoaded = true;
+		return true;
+	}
+
+	//Loads and parks sprites until every frame has enough for the number of instances to be alive at once
+	//Loads sprites so must be called when loading, not while animations play
+	//Returns false if any frame could not be loaded
+	bool CFrameSet::Preload(int instances)
+	{
+		if (instances > mPreloaded) mPreloaded = instances;
+
+		for (int frame = 0; frame < static_cast<int>(mFrames.size()); ++frame)
+		{
+			while (mSpriteCounts[frame] < mPreloaded)
+			{
+				ISprite* sprite = LoadSprite(frame);
+				if (!sprite) return false;
+				Park(frame, sprite, 0.0f);
+			}
+		}
+
+		mLoaded = true;
+		return true;
+	}
+
+	//Returns a sprite of the frame, loading one only if none are idle
+	//The depth is set to the sprite's current depth
+	//Returns 0 if the image could not be loaded
+	ISprite* CFrameSet::TakeSprite(int frame, float& z)
+	{
+		std::vector<SIdleSprite>& idle = mIdleSprites[frame];
+		if (!idle.empty())
+		{
+			ISprite* sprite = idle.back().mpSprite;
+			z = idle.back().mZ;
+			idle.pop_back();
+			--mIdleSpriteCount;
+			return sprite;
+		}
+
+		//New sprites are created at a depth of 0
+		z = 0.0f;
+		return LoadSprite(frame);
+	}
+
+	//Loads a new sprite of the frame off screen
+	//Returns 0 if the image could not be loaded
+	ISprite* CFrameSet::LoadSprite(int frame)
+	{
+		ISprite* sprite = mpEngine->CreateSprite(mFrames[frame], static_cast<float>(mpEngine->GetWidth()),
+													static_cast<float>(mpEngine->GetHeight()));
+		if (!sprite)
+		{
+			std::cout << "Could not load image file \"" + mFrames[frame] + "\"";
+			return 0;
+		}
+		++mSpriteCounts[frame];
+		return sprite;
+	}
+
+	//Fills the vectors with a sprite for every frame and the sprite's current depth
+	//Returns false and takes nothing if any frame could not be loaded
+	bool CFrameSet::TakeSprites(SpriteVector& sprites, std::vector<float>& depths)
+	{
+		sprites.clear();
+		sprites.reserve(mFrames.size());
+		depths.clear();
+		depths.reserve(mFrames.size());
+		for (int frame = 0; frame < static_cast<int>(mFrames.size()); ++frame)
+		{
+			float z;
+			ISprite* sprite = TakeSprite(frame, z);
+			if (!sprite)
+			{
+				//The frames already taken loaded fine so keep them for next time
+				ReturnSprites(sprites, depths);
+				return false;
+			}
+			sprites.push_back(sprite);
+			depths.push_back(z);
+		}
+		return true;
+	}
+
+	//Starts reading the frame's image in the background so taking a sprite of it later doesn't wait on the disk
+	void CFrameSet::Prefetch(int frame)
+	{
+		mpEngine->PrefetchFile(mFrames[frame]);
+	}
+
+	//Parks the sprite off screen for later use, it is removed if there are already enough idle sprites of the frame
+	//The depth is the one the sprite was last given
+	void CFrameSet::ReturnSprite(int frame, ISprite* sprite, float z)
+	{
+		if (static_cast<int>(mIdleSprites[frame].size()) >= kMaxIdleSprites + GetReservedSprites(frame) && CanRemove(frame))
+		{
+			RemoveSprite(frame, sprite);
+			return;
+		}
+
+		Park(frame, sprite, z);
+	}
+
+	//Removes a sprite taken from the frame set instead of parking it
+	void CFrameSet::RemoveSprite(int frame, ISprite* sprite)
+	{
+		mpEngine->RemoveSprite(sprite);
+		--mSpriteCounts[frame];
+	}
+
+	//Parks a sprite for every frame
+	void CFrameSet::ReturnSprites(SpriteVector& sprites, std::vector<float>& depths)
+	{
+		for (int frame = 0; frame < static_cast<int>(sprites.size()); ++frame)
+		{
+			if (sprites[frame]) ReturnSprite(frame, sprites[frame], depths[frame]);
+		}
+		sprites.clear();
+		depths.clear();
+	}
+
+	//Counts a new SingleSprite animation and parks enough sprites of every frame for it
+	//Loads sprites so must be called when the animation is created, not while it plays
+	void CFrameSet::AddBorrower()
+	{
+		++mBorrowers;
+		for (int frame = 0; frame < static_cast<int>(mFrames.size()); ++frame)
+		{
+			std::vector<SIdleSprite>& idle = mIdleSprites[frame];
+			idle.reserve(mBorrowers);
+			while (static_cast<int>(idle.size()) < GetReservedSprites(frame))
+			{
+				//Taking an idle sprite and parking it again wouldn't add one, so a new one is always loaded
+				ISprite* sprite = LoadSprite(frame);
+				if (!sprite) break;
+				Park(frame, sprite, 0.0f);
+			}
+		}
+	}
+
+	//Stops counting a SingleSprite animation that has handed back its sprite
+	void CFrameSet::RemoveBorrower()
+	{
+		--mBorrowers;
+	}
+
+	//Hands a SingleSprite animation a parked sprite of the frame and sets the depth to the sprite's depth
+	//One is always parked for each borrower so no sprite is loaded
+	ISprite* CFrameSet::BorrowSprite(int frame, float& z)
+	{
+		ISprite* sprite = TakeSprite(frame, z);
+		if (sprite) ++mBorrowed[frame];
+		return sprite;
+	}
+
+	//Parks a sprite borrowed by a SingleSprite animation, it is never removed
+	void CFrameSet::ParkSprite(int frame, ISprite* sprite, float z)
+	{
+		--mBorrowed[frame];
+		Park(frame, sprite, z);
+	}
+
+	//Moves the sprite off screen and adds it to the frame's idle sprites
+	void CFrameSet::Park(int frame, ISprite* sprite, float z)
+	{
+		sprite->SetPosition(static_cast<float>(mpEngine->GetWidth()),
+			static_cast<float>(mpEngine->GetHeight()));
+		mIdleSprites[frame].push_back(SIdleSprite{ sprite, z });
+		++mIdleSpriteCount;
+	}
+
+	//Returns true if an idle sprite of the frame can be removed without going below the preloaded number
+	bool CFrameSet::CanRemove(int frame)
+	{
+		return mSpriteCounts[frame] > mPreloaded;
+	}
+
+	//Returns how many idle sprites of the frame are set aside for SingleSprite animations
+	int CFrameSet::GetReservedSprites(int frame)
+	{
+		return mBorrowers - mBorrowed[frame];
+	}
+
+	//Returns a finished one shot animation of the mode or null if there are none
+	std::unique_ptr<CAnimation> CFrameSet::TakeIdleAnimation(EAnimationMode mode)
+	{
+		vector_ptr<CAnimation>& idle = mIdleAnimations[mode];
+		if (idle.empty()) return std::unique_ptr<CAnimation>();
+
+		std::unique_ptr<CAnimation> animation = move(idle.back());
+		idle.pop_back();
+		return animation;
+	}
+
+	//Takes ownership of the finished animation if there is room in the pool
+	//If the pool is full the animation is left with the caller to be destroyed
+	void CFrameSet::ReturnIdleAnimation(std::unique_ptr<CAnimation>&& animation)
+	{
+		vector_ptr<CAnimation>& idle = mIdleAnimations[animation->GetMode()];
+		if (static_cast<int>(idle.size()) >= kMaxIdleAnimations) return;
+
+		animation->Park();
+		idle.push_back(move(animation));
+	}
+
+	//Removes all idle animations and sprites, apart from the sprites set aside for SingleSprite animations
+	//and those needed to keep the preloaded number of sprites
+	void CFrameSet::ClearIdleSprites()
+	{
+		//The animations hand their sprites back to be removed below
+		mIdleAnimations[AllFrames].clear();
+		mIdleAnimations[SingleSprite].clear();
+		mIdleAnimations[Streamed].clear();
+
+		for (int frame = 0; frame < static_cast<int>(mIdleSprites.size()); ++frame)
+		{
+			std::vector<SIdleSprite>& idle = mIdleSprites[frame];
+			int keep = GetReservedSprites(frame);
+			while (static_cast<int>(idle.size()) > keep && CanRemove(frame))
+			{
+				RemoveSprite(frame, idle.back().mpSprite);
+				idle.pop_back();
+				--mIdleSpriteCount;
+			}
+		}
+	}
+
+	//Returns the number of frames
+	int CFrameSet::GetFrameCount()
+	{
+		return static_cast<int>(mFrames.size());
+	}
+
+	//Returns the number of idle sprites, including those held by idle animations
+	int CFrameSet::GetIdleSpriteCount()
+	{
+		int count = mIdleSpriteCount;
+		for (int mode = AllFrames; mode <= Streamed; ++mode)
+		{
+			for (auto animation = mIdleAnimations[mode].begin(); animation != mIdleAnimations[mode].end(); ++animation)
+			{
+				count += (*animation)->GetSpriteCount();
+			}
+		}
+		return count;
+	}
+
+	//Returns the number of idle animations
+	int CFrameSet::GetIdleAnimationCount()
+	{
+		return static_cast<int>(mIdleAnimations[AllFrames].size() + mIdleAnimations[SingleSprite].size() + mIdleAnimations[Streamed].size());
+	}
+
+	//Returns an estimate of the memory held by the frame set in bytes
+	size_t CFrameSet::GetMemoryUsage()
+	{
+		size_t bytes = sizeof(CFrameSet) + mFrames.capacity() * sizeof(string) + mIdleSprites.capacity() * sizeof(std::vector<SIdleSprite>) +
+			mBorrowed.capacity() * sizeof(int) + mSpriteCounts.capacity() * sizeof(int);
+		for (auto idle = mIdleSprites.begin(); idle != mIdleSprites.end(); ++idle)
+		{
+			bytes += idle->capacity() * sizeof(SIdleSprite);
+		}
+		for (int mode = AllFrames; mode <= Streamed; ++mode)
+		{
+			for (auto animation = mIdleAnimations[mode].begin(); animation != mIdleAnimations[mode].end(); ++animation)
+			{
+				bytes += (*animation)->GetMemoryUsage();
+			}
+		}
+		return bytes;
+	}
+
+	CFrameSet::~CFrameSet()
+	{
+		ClearIdleSprites();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+#pragma once
+#include <vector>
+#include "IUsings.h"
+#include "IAnimation.h"
+#include "Sprite.h"
+
+namespace tle
+{
+	//Hacky work around to avoid circular reference
+	class ExEngine;
+	class CAnimation;
+
+	using SpriteVector = std::vector<ISprite*>;
+
+	//The frames of an animation shared by every animation created from the same frame list
+	//Sprites of animations that are removed are parked off screen and handed to the next animation
+	//Animations alive at the same time each need their own sprites, so without a preload every instance past
+	//the number already parked loads the images when it is created
+	//SingleSprite animations borrow a sprite of the frame they show, enough sprites of every frame are kept parked
+	//for them so changing frame never loads or removes a sprite
+	class CFrameSet
+	{
+	private:
+		//Most idle sprites kept around for each frame, any more are removed
+		//Sprites set aside for SingleSprite animations are kept on top of this
+		static const int kMaxIdleSprites = 64;
+
+		//A parked sprite and the depth it was last given, so it is only given a new depth if it differs
+		struct SIdleSprite
+		{
+			ISprite* mpSprite;
+			float mZ;
+		};
+
+		//Most finished one shot animations of each mode kept around at once, any more are destroyed
+		static const int kMaxIdleAnimations = 64;
+
+		std::vector<string> mFrames;
+		bool mLoaded; //Every frame has been loaded at least once
+
+		//Parked sprites waiting to be used again, one list for each frame
+		std::vector<std::vector<SIdleSprite>> mIdleSprites;
+		int mIdleSpriteCount;
+
+		//Sprites of each frame that exist, whether parked or held by an animation
+		//Never removed below the preloaded number so that many instances can always be created without loading
+		std::vector<int> mSpriteCounts;
+		int mPreloaded;
+
+		//Number of SingleSprite animations of the frame set and how many sprites of each frame they have borrowed
+		//Every frame keeps enough sprites for all of them to show that frame at once
+		int mBorrowers;
+		std::vector<int> mBorrowed;
+
+		//Finished one shot animations waiting to be played again, one list for each animation mode
+		//They keep their sprites so playing them again doesn't take any from the frame set
+		vector_ptr<CAnimation> mIdleAnimations[3];
+
+		ExEngine* mpEngine;
+
+		//Returns how many idle sprites of the frame are set aside for SingleSprite animations
+		int GetReservedSprites(int frame);
+
+		//Moves the sprite off screen and adds it to the frame's idle sprites
+		void Park(int frame, ISprite* sprite, float z);
+
+		//Loads a new sprite of the frame off screen
+		//Returns 0 if the image could not be loaded
+		ISprite* LoadSprite(int frame);
+
+		//Returns true if an idle sprite of the frame can be removed without going below the preloaded number
+		bool CanRemove(int frame);
+
+	public:
+		//Creates an empty frame set, no images are loaded until sprites are taken
+		CFrameSet(ExEngine* engine, const std::vector<string>& frames);
+
+		//Makes sure every frame can be loaded, only loads the images the first time it is called
+		//Returns false if any frame could not be loaded
+		bool Load();
+
+		//Loads and parks sprites until every frame has enough for the number of instances to be alive at once
+		//Loads sprites so must be called when loading, not while animations play
+		//Returns false if any frame could not be loaded
+		bool Preload(int instances);
+
+		//Returns a sprite of the frame, loading one only if none are idle
+		//The depth is set to the sprite's current depth
+		//Returns 0 if the image could not be loaded
+		ISprite* TakeSprite(int frame, float& z);
+
+		//Fills the vectors with a sprite for every frame and the sprite's current depth
+		//Returns false and takes nothing if any frame could not be loaded
+		bool TakeSprites(SpriteVector& sprites, std::vector<float>& depths);
+
+		//Starts reading the frame's image in the background so taking a sprite of it later doesn't wait on the disk
+		void Prefetch(int frame);
+
+		//Parks the sprite off screen for later use, it is removed if there are already enough idle sprites of the frame
+		//The depth is the one the sprite was last given
+		void ReturnSprite(int frame, ISprite* sprite, float z);
+
+		//Removes a sprite taken from the frame set instead of parking it
+		void RemoveSprite(int frame, ISprite* sprite);
+
+		//Parks a sprite for every frame, frames without a sprite are skipped
+		void ReturnSprites(SpriteVector& sprites, std::vector<float>& depths);
+
+		//Counts a new SingleSprite animation and parks enough sprites of every frame for it
+		//Loads sprites so must be called when the animation is created, not while it plays
+		void AddBorrower();
+
+		//Stops counting a SingleSprite animation that has handed back its sprite
+		void RemoveBorrower();
+
+		//Hands a SingleSprite animation a parked sprite of the frame and sets the depth to the sprite's depth
+		//One is always parked for each borrower so no sprite is loaded
+		ISprite* BorrowSprite(int frame, float& z);
+
+		//Parks a sprite borrowed by a SingleSprite animation, it is never removed
+		void ParkSprite(int frame, ISprite* sprite, float z);
+
+		//Returns a finished one shot animation of the mode or null if there are none
+		std::unique_ptr<CAnimation> TakeIdleAnimation(EAnimationMode mode);
+
+		//Takes ownership of the finished animation if there is room in the pool
+		//If the pool is full the animation is left with the caller to be destroyed
+		void ReturnIdleAnimation(std::unique_ptr<CAnimation>&& animation);
+
+		//Removes all idle animations and sprites, apart from the sprites set aside for SingleSprite animations
+		//and those needed to keep the preloaded number of sprites
+		void ClearIdleSprites();
+
+		//Returns the number of frames
+		int GetFrameCount();
+
+		//Returns the number of idle sprites, including those held by idle animations
+		int GetIdleSpriteCount();
+
+		//Returns the number of idle animations
+		int GetIdleAnimationCount();
+
+		//Returns an estimate of the memory held by the frame set in bytes
+		size_t GetMemoryUsage();
+
+		~CFrameSet();
+	};
+}
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "stdafx.h"
+#include "CJobSystem.h"
+
+namespace tle
+{
+	//Creates the workers, a count of 0 or less uses one less than the number of cores
+	//as the main thread also runs jobs while it waits
+	CJobSystem::CJobSystem(int workers)
+	{
+		if (workers <= 0) workers = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+		if (workers < 0) workers = 0;
+
+		mNextQueue = 0;
+		mQueued = 0;
+		mPending = 0;
+		mQuit = false;
+
+		//The main thread gets the last queue so it has somewhere to take jobs from while it waits
+		for (int i = 0; i <= workers; ++i)
+		{
+			mQueues.push_back(std::unique_ptr<SJobQueue>(new SJobQueue()));
+		}
+		for (int i = 0; i < workers; ++i)
+		{
+			mWorkers.push_back(std::thread(&CJobSystem::WorkerLoop, this, i));
+		}
+	}
+
+	//Takes a job from the back of the queue, or steals from the front of another if it is empty
+	//Returns false if every queue is empty
+	bool CJobSystem::TakeJob(int queue, Job& job)
+	{
+		const int queues = static_cast<int>(mQueues.size());
+
+		//Own queue first, newest job as its data is most likely still in cache
+		{
+			SJobQueue& own = *mQueues[queue];
+			std::lock_guard<std::mutex> lock(own.mLock);
+			if (!own.mJobs.empty())
+			{
+				job = std::move(own.mJobs.back());
+				own.mJobs.pop_back();
+				--mQueued;
+				return true;
+			}
+		}
+
+		//Steal the oldest job of the next queue that has any
+		for (int i = 1; i < queues; ++i)
+		{
+			SJobQueue& other = *mQueues[(queue + i) % queues];
+			std::lock_guard<std::mutex> lock(other.mLock);
+			if (!other.mJobs.empty())
+			{
+				job = std::move(other.mJobs.front());
+				other.mJobs.pop_front();
+				--mQueued;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	//Runs jobs until the system is destroyed
+	void CJobSystem::WorkerLoop(int queue)
+	{
+		Job job;
+		while (true)
+		{
+			if (TakeJob(queue, job))
+			{
+				job();
+				job = nullptr;
+				--mPending;
+				continue;
+			}
+
+			//Sleep until there is something to take
+			std::unique_lock<std::mutex> lock(mWakeLock);
+			mWake.wait(lock, [this] { return mQuit || mQueued > 0; });
+			if (mQuit) return;
+		}
+	}
+
+	//Adds a job to be run by the workers
+	void CJobSystem::Submit(const Job& job)
+	{
+		++mPending;
+
+		SJobQueue& queue = *mQueues[mNextQueue];
+		mNextQueue = (mNextQueue + 1) % static_cast<int>(mQueues.size());
+		{
+			std::lock_guard<std::mutex> lock(queue.mLock);
+			queue.mJobs.push_back(job);
+		}
+
+		//Taking the wake lock stops a worker missing the notify between checking the count and sleeping
+		{
+			std::lock_guard<std::mutex> lock(mWakeLock);
+			++mQueued;
+		}
+		mWake.notify_one();
+	}
+
+	//Runs jobs on the calling thread until every submitted job has finished
+	void CJobSystem::Wait()
+	{
+		const int mainQueue = static_cast<int>(mQueues.size()) - 1;
+
+		Job job;
+		while (mPending > 0)
+		{
+			if (TakeJob(mainQueue, job))
+			{
+				job();
+				job = nullptr;
+				--mPending;
+			}
+			else
+			{
+				//The last jobs are running on the workers
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	//Calls the function once for every index from 0 to count and waits for them all to finish
+	//Runs on the calling thread if there are no workers
+	void CJobSystem::ParallelFor(int count, const std::function<void(int)>& function)
+	{
+		if (mWorkers.empty() || count <= 1)
+		{
+			for (int i = 0; i < count; ++i)
+			{
+				function(i);
+			}
+			return;
+		}
+
+		for (int i = 0; i < count; ++i)
+		{
+			Submit([&function, i] { function(i); });
+		}
+		Wait();
+	}
+
+	//Returns the number of worker threads, not counting the main thread
+	int CJobSystem::GetWorkerCount()
+	{
+		return static_cast<int>(mWorkers.size());
+	}
+
+	CJobSystem::~CJobSystem()
+	{
+		Wait();
+
+		{
+			std::lock_guard<std::mutex> lock(mWakeLock);
+			mQuit = true;
+		}
+		mWake.notify_all();
+
+		for (auto worker = mWorkers.begin(); worker != mWorkers.end(); ++worker)
+		{
+			worker->join();
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include "IUsings.h"
+
+namespace tle
+{
+	//A pool of worker threads sized to the core count that run jobs submitted from the main thread
+	//Every worker has its own queue, jobs are taken from the back of a worker's own queue and
+	//stolen from the front of the others when it runs dry so uneven jobs still spread over all cores
+	//The main thread helps run the jobs while it waits for them to finish
+	class CJobSystem
+	{
+	public:
+		using Job = std::function<void()>;
+
+	private:
+		struct SJobQueue
+		{
+			std::deque<Job> mJobs;
+			std::mutex mLock;
+		};
+
+		vector_ptr<SJobQueue> mQueues;
+		std::vector<std::thread> mWorkers;
+		int mNextQueue; //Queue the next submitted job is pushed to, jobs are dealt round robin
+
+		//Jobs waiting in the queues and jobs not yet finished
+		std::atomic<int> mQueued;
+		std::atomic<int> mPending;
+
+		//Sleeping workers are woken when jobs are submitted
+		std::mutex mWakeLock;
+		std::condition_variable mWake;
+		bool mQuit;
+
+		//Takes a job from the back of the queue, or steals from the front of another if it is empty
+		//Returns false if every queue is empty
+		bool TakeJob(int queue, Job& job);
+
+		//Runs jobs until the system is destroyed
+		void WorkerLoop(int queue);
+
+	public:
+		//Creates the workers, a count of 0 or less uses one less than the number of cores
+		//as the main thread also runs jobs while it waits
+		CJobSystem(int workers = 0);
+
+		//Adds a job to be run by the workers
+		void Submit(const Job& job);
+
+		//Runs jobs on the calling thread until every submitted job has finished
+		void Wait();
+
+		//Calls the function once for every index from 0 to count and waits for them all to finish
+		//Runs on the calling thread if there are no workers
+		void ParallelFor(int count, const std::function<void(int)>& function);
+
+		//Returns the number of worker threads, not counting the main thread
+		int GetWorkerCount();
+
+		~CJobSystem();
+	};
+}
\ No newline at end of file
@@ -11,6 +11,7 @@ namespace tle
 		mVolume = 100.0f;
 		mpMusic = music;
 		mpManager = manager;
+		mWatchSlot = -1;
 
 		mpMusic->setVolume(mpManager->GetVolume(mType));
 	}
@@ -41,6 +42,7 @@ namespace tle
 	void CMusic::Play()
 	{
 		mpMusic->play();
+		mpManager->WatchMusic(this);
 	}
 
 	//Pause the music, Play() will resume
@@ -85,9 +87,22 @@ namespace tle
 		return mpMusic->getStatus();
 	}
 
+	//Gets the number of samples per second of the music stream
+	unsigned int CMusic::GetSampleRate()
+	{
+		return mpMusic->getSampleRate();
+	}
+
+	//Gets the number of channels of the music stream
+	unsigned int CMusic::GetChannelCount()
+	{
+		return mpMusic->getChannelCount();
+	}
+
 	//Destroys the music
 	CMusic::~CMusic()
 	{
+		mpManager->UnwatchMusic(this);
 		delete mpMusic;
 	}
 }
\ No newline at end of file
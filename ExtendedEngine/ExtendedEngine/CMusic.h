@@ -1,5 +1,5 @@
 #pragma once
-#include <SFML\Audio\Music.hpp>
+#include <SFML/Audio/Music.hpp>
 #include "IMusic.h"
 
 namespace tle
@@ -15,6 +15,9 @@ namespace tle
 		sf::Music* mpMusic;			//The internal sound object
 
 		float mVolume;				//The individual volume control
+		int mWatchSlot;				//Slot in the manager's list of played music to check for stopping, -1 if not in it
+
+		friend class CSoundManager;
 
 	public:
 		//Creates a music object
@@ -53,6 +56,12 @@ namespace tle
 		//Returns whether the music is currently playing, paused, or stopped
 		virtual sf::SoundSource::Status GetStatus();
 
+		//Gets the number of samples per second of the music stream
+		virtual unsigned int GetSampleRate();
+
+		//Gets the number of channels of the music stream
+		virtual unsigned int GetChannelCount();
+
 		//Destroys the music
 		~CMusic();
 	};
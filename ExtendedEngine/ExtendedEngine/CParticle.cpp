@@ -2,24 +2,64 @@
 #include "CParticle.h"
 #include "ExEngine.h"
 #include <iostream>
+#include <cmath>
 
 namespace tle
 {
-	//Creates a particle model from the mesh
-	CParticle::CParticle(ParticleData* data, ExEngine* engine)
+	//Bakes keys spread evenly over a particle's life into the samples of a curve
+	//Values between the keys are interpolated linearly
+	void BakeCurve(const std::vector<float>& keys, float* samples)
 	{
-		mpEngine = engine;
-		mpData = data;
-		
+		if (keys.empty()) return;
+
+		const int lastKey = static_cast<int>(keys.size()) - 1;
+		for (int i = 0; i < kCurveSamples; ++i)
+		{
+			if (lastKey == 0)
+			{
+				samples[i] = keys[0];
+				continue;
+			}
+
+			float position = static_cast<float>(i) / (kCurveSamples - 1) * lastKey;
+			int key = static_cast<int>(position);
+			if (key >= lastKey) key = lastKey - 1;
+			float blend = position - key;
+			samples[i] = keys[key] + (keys[key + 1] - keys[key]) * blend;
+		}
+	}
+
+	//Creates an unused particle
+	//A model is only taken from the engine the first time the particle is reset
+	CParticle::CParticle()
+	{
+		mpEngine = 0;
+		mpData = 0;
+		mpModel = 0;
+		mModelTexture = 0;
+		mModelOrder = 0;
+		mShownFrame = -1;
+
 		mTextureIndex = 0;
 		mTextureTimer = 0.0f;
 
-		mpModel = engine->GetParticleModel(mpData->mTexture[mTextureIndex]);
-		mpModel->ResetScale();
-		mpModel->Scale(mpData->mScale);
+		mLife = -1.0f;
+		mScale = 1.0f;
+		mCurveScale = 1.0f;
+		for (int i = 0; i < 16; ++i)
+		{
+			mMatrix[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+		}
 
-		mLife = mpData->mMaxLife;
-		mVel = mpData->mVel;
+		mpNext = 0;
+		mpPrev = 0;
+	}
+
+	//Sets the shared particle data and the engine the particle's models come from
+	void CParticle::Init(ParticleData* data, ExEngine* engine)
+	{
+		mpData = data;
+		mpEngine = engine;
 	}
 
 	/********************************
@@ -27,6 +67,7 @@ namespace tle
 	*********************************/
 
 	//Updates the particle velocity, life, and location
+	//Only touches the particle itself so particles of different emitters can be updated on different threads
 	void CParticle::Update(float delta)
 	{
 		mLife -= delta;
@@ -36,61 +77,318 @@ namespace tle
 		mVel += mpData->mAcl;
 		mTextureTimer += delta;
 
-		//Note: If the total time passed is exactly equal or higher than the particle's max life then the texture
-		//index is incremented pass the end of the vector, so avoid it
-		while (mTextureTimer > mpData->mAnimationRate && static_cast<int>(mpData->mTexture.size() - 1) > mTextureIndex)
+		//Sample the over-life curves at the particle's age
+		if (!mpData->mScaleKeys.empty() || !mpData->mDragKeys.empty())
 		{
-			float matrix[16];
+			float age = mpData->mMaxLife > 0.0f ? 1.0f - mLife / mpData->mMaxLife : 1.0f;
+			int sample = static_cast<int>(age * (kCurveSamples - 1) + 0.5f);
+			if (sample < 0) sample = 0;
+			if (sample >= kCurveSamples) sample = kCurveSamples - 1;
 
-			mpModel->GetMatrix(matrix);
-			mpEngine->ReturnParticleModel(mpModel, mpData->mTexture[mTextureIndex]);
+			if (!mpData->mScaleKeys.empty()) mCurveScale = mpData->mScaleCurve[sample];
+			if (!mpData->mDragKeys.empty())
+			{
+				float keep = 1.0f - mpData->mDragCurve[sample] * delta;
+				if (keep < 0.0f) keep = 0.0f;
+				mVel.x *= keep;
+				mVel.y *= keep;
+				mVel.z *= keep;
+			}
+		}
 
+		//Note: If the total time passed is exactly equal or higher than the particle's max life then the texture
+		//index is incremented pass the end of the vector, so avoid it
+		const int lastFrame = static_cast<int>(mpData->mTexture.size()) - 1;
+		while (mTextureTimer > mpData->mAnimationRate && lastFrame > mTextureIndex)
+		{
 			mTextureTimer -= mpData->mAnimationRate;
 			++mTextureIndex;
+		}
+
+		//The skin may have been changed to one with fewer frames since the particle was spawned
+		if (mTextureIndex > lastFrame) mTextureIndex = lastFrame;
 
-			mpModel = mpEngine->GetParticleModel(mpData->mTexture[mTextureIndex]);
-			mpModel->SetMatrix(matrix);
-			mpModel->ResetScale();
-			mpModel->Scale(mpData->mScale);
+		//Move along the local axes
+		for (int i = 0; i < 3; ++i)
+		{
+			mMatrix[12 + i] += mMatrix[i] * mVel.x + mMatrix[4 + i] * mVel.y + mMatrix[8 + i] * mVel.z;
 		}
-		
-		mpModel->MoveLocal(mVel.x, mVel.y, mVel.z);
 	}
 
 	//Reset the velocity and health of the particle
+	//Only touches the particle itself, the model is swapped on the next apply
 	void CParticle::Reset()
 	{
-		mpEngine->ReturnParticleModel(mpModel, mpData->mTexture[mTextureIndex]);
-
-		mTextureIndex = 0;
 		mTextureTimer = 0.0f;
+		mTextureIndex = 0;
 
-		mpModel = mpEngine->GetParticleModel(mpData->mTexture[mTextureIndex]);
-		mpModel->ResetScale();
-		mpModel->Scale(mpData->mScale);
-
+		mScale = mpData->mScale;
+		mCurveScale = mpData->mScaleKeys.empty() ? 1.0f : mpData->mScaleCurve[0];
 		mLife = mpData->mMaxLife;
 		mVel = mpData->mVel;
+	}
+
+	//Cuts the particle's remaining life to at most the given time
+	void CParticle::LimitLife(float life)
+	{
+		if (mLife > life) mLife = life;
+	}
 
+	//Copies the particle's transform to its model, swapping the model if the frame of the animation has changed
+	//Calls into the TL-Engine so must only be called from the main thread
+	void CParticle::Apply()
+	{
+		if (mpData->mFlipbook)
+		{
+			ShowFrame();
+		}
+		else
+		{
+			//Flipbook quads are handed back if the emitter has stopped using them
+			if (!mFrameModels.empty()) ReleaseModel();
+
+			const int texture = mpData->mTexture[mTextureIndex];
+			if (mpModel && mModelTexture != texture) ReleaseModel();
+			if (!mpModel)
+			{
+				SParticleModel model = mpEngine->GetParticleModel(texture);
+				mpModel = model.mpModel;
+				mModelOrder = model.mOrder;
+				mModelTexture = texture;
+			}
+		}
+
+		float matrix[16];
+		for (int i = 0; i < 12; ++i)
+		{
+			matrix[i] = mMatrix[i] * mScale * mCurveScale;
+		}
+		for (int i = 12; i < 16; ++i)
+		{
+			matrix[i] = mMatrix[i];
+		}
+		for (int i = 3; i < 12; i += 4)
+		{
+			matrix[i] = 0.0f;
+		}
+		mpModel->SetMatrix(matrix);
+	}
+
+	//Takes a model for the first frame of the animation from the engine if the particle doesn't have one
+	//Flipbook particles take a model for every frame
+	void CParticle::PrepareModel()
+	{
+		if (mpData->mFlipbook)
+		{
+			mTextureIndex = 0;
+			ShowFrame();
+			return;
+		}
+
+		if (mpModel) return;
+
+		mTextureIndex = 0;
+		mModelTexture = mpData->mTexture[mTextureIndex];
+		SParticleModel model = mpEngine->GetParticleModel(mModelTexture);
+		mpModel = model.mpModel;
+		mModelOrder = model.mOrder;
 	}
 
 	//Hides the particle at the position specified
+	//Flipbook particles hide the quad of every frame
 	void CParticle::HideAt(CVector3& position)
 	{
+		for (auto model = mFrameModels.begin(); model != mFrameModels.end(); ++model)
+		{
+			model->mpModel->SetPosition(position.x, position.y, position.z);
+		}
+
+		//Particles that have never been spawned don't have a model to hide
+		if (!mpModel) return;
+
 		mpModel->SetPosition(position.x,
 								position.y,
 								position.z);
 	}
 
+	//Hides the quads of the frames a flipbook particle isn't showing at the position specified
+	//Moved out of view rather than shrunk so the TL-Engine culls them instead of drawing them
+	void CParticle::HideFrames(CVector3& position)
+	{
+		for (int frame = 0; frame < static_cast<int>(mFrameModels.size()); ++frame)
+		{
+			if (frame != mShownFrame) mFrameModels[frame].mpModel->SetPosition(position.x, position.y, position.z);
+		}
+	}
+
+	//Returns the particle's model, or every model of a flipbook particle, to the engine
+	//A new model will be taken the next time the particle is reset
+	void CParticle::ReleaseModel()
+	{
+		if (!mFrameModels.empty())
+		{
+			for (size_t i = 0; i < mFrameModels.size(); ++i)
+			{
+				mpEngine->ReturnParticleModel(mFrameModels[i], mFrameTextures[i]);
+			}
+			mFrameModels.clear();
+			mFrameTextures.clear();
+			mShownFrame = -1;
+			mpModel = 0;
+		}
+
+		//If there's a model then return it
+		if (mpModel)
+		{
+			mpEngine->ReturnParticleModel(SParticleModel{ mpModel, mModelOrder }, mModelTexture);
+			mpModel = 0;
+		}
+	}
+
+	//Makes the quad of the current frame the particle's model, the quad of the last frame shown is hidden
+	//by HideFrames when the scene is next drawn
+	//Takes a quad for every frame the first time, or after the skin has changed
+	void CParticle::ShowFrame()
+	{
+		if (mFrameTextures != mpData->mTexture)
+		{
+			ReleaseModel();
+
+			mFrameTextures = mpData->mTexture;
+			for (auto texture = mFrameTextures.begin(); texture != mFrameTextures.end(); ++texture)
+			{
+				mFrameModels.push_back(mpEngine->GetParticleModel(*texture));
+			}
+		}
+
+		if (mShownFrame == mTextureIndex) return;
+
+		mShownFrame = mTextureIndex;
+		mpModel = mFrameModels[mShownFrame].mpModel;
+		mModelOrder = mFrameModels[mShownFrame].mOrder;
+		mModelTexture = mFrameTextures[mShownFrame];
+	}
+
+	/********************************
+				  Collision
+	*********************************/
+
+	//Pushes the particle out of any collider it has moved into and bounces or kills it
+	//Emitters test their particles in batches, this is for a single particle such as one that has just spawned
+	void CParticle::Collide()
+	{
+		const float* position = mMatrix + 12;
+
+		for (int i = 0; i < mpData->mNumPlanes; ++i)
+		{
+			const SCollider& plane = mpData->mPlanes[i];
+			const CVector3& normal = plane.mVector;
+			float distance = position[0] * normal.x + position[1] * normal.y + position[2] * normal.z - plane.mValue;
+			if (distance < 0.0f && HitPlane(plane, distance)) return;
+		}
+
+		for (int i = 0; i < mpData->mNumSpheres; ++i)
+		{
+			const SCollider& sphere = mpData->mSpheres[i];
+			CVector3 offset(position[0] - sphere.mVector.x, position[1] - sphere.mVector.y, position[2] - sphere.mVector.z);
+			float distanceSquared = offset.x * offset.x + offset.y * offset.y + offset.z * offset.z;
+			if (distanceSquared < sphere.mValue * sphere.mValue && HitSphere(sphere, distanceSquared)) return;
+		}
+	}
+
+	//Bounces the particle off a plane it is the distance behind, or kills it
+	//Returns true if the particle was killed
+	bool CParticle::HitPlane(const SCollider& plane, float distance)
+	{
+		if (plane.mKill)
+		{
+			mLife = -1.0f;
+			return true;
+		}
+
+		//Back onto the surface of the plane
+		const CVector3& normal = plane.mVector;
+		float* position = mMatrix + 12;
+		position[0] -= normal.x * distance;
+		position[1] -= normal.y * distance;
+		position[2] -= normal.z * distance;
+		Reflect(normal, plane.mBounciness);
+		return false;
+	}
+
+	//Bounces the particle off a sphere it is inside of, the distance squared from its centre, or kills it
+	//Returns true if the particle was killed
+	bool CParticle::HitSphere(const SCollider& sphere, float distanceSquared)
+	{
+		if (sphere.mKill)
+		{
+			mLife = -1.0f;
+			return true;
+		}
+
+		//Out to the surface of the sphere, straight up if the particle is exactly at the centre
+		float* position = mMatrix + 12;
+		float distance = sqrtf(distanceSquared);
+		CVector3 normal(0.0f, 1.0f, 0.0f);
+		if (distance > 0.0f)
+		{
+			normal = CVector3((position[0] - sphere.mVector.x) / distance, (position[1] - sphere.mVector.y) / distance,
+				(position[2] - sphere.mVector.z) / distance);
+		}
+
+		position[0] = sphere.mVector.x + normal.x * sphere.mValue;
+		position[1] = sphere.mVector.y + normal.y * sphere.mValue;
+		position[2] = sphere.mVector.z + normal.z * sphere.mValue;
+		Reflect(normal, sphere.mBounciness);
+		return false;
+	}
+
+	//Reflects the part of the velocity heading into the surface with the given world space normal
+	//The velocity is kept along the particle's local axes so it is turned into world space and back
+	void CParticle::Reflect(const CVector3& normal, float bounciness)
+	{
+		float world[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			world[i] = mMatrix[i] * mVel.x + mMatrix[4 + i] * mVel.y + mMatrix[8 + i] * mVel.z;
+		}
+
+		float into = world[0] * normal.x + world[1] * normal.y + world[2] * normal.z;
+		if (into >= 0.0f) return;
+
+		float push = (1.0f + bounciness) * into;
+		world[0] -= normal.x * push;
+		world[1] -= normal.y * push;
+		world[2] -= normal.z * push;
+
+		mVel.x = world[0] * mMatrix[0] + world[1] * mMatrix[1] + world[2] * mMatrix[2];
+		mVel.y = world[0] * mMatrix[4] + world[1] * mMatrix[5] + world[2] * mMatrix[6];
+		mVel.z = world[0] * mMatrix[8] + world[1] * mMatrix[9] + world[2] * mMatrix[10];
+	}
+
 	/********************************
 				   Sets
 	*********************************/
 
 	//Sets the particle's position/rotation matrix
-	void CParticle::SetMatrix(float* matrix)
+	//Any scale in the matrix is removed
+	void CParticle::SetMatrix(const float* matrix)
 	{
-		mpModel->SetMatrix(matrix);
-		//std::cout << "Particle Created at: (" << matrix[12] << ',' << matrix[13] << ',' << matrix[14] << ')' << std::endl;
+		for (int row = 0; row < 3; ++row)
+		{
+			const float* axis = matrix + row * 4;
+			float length = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+			if (length == 0.0f) length = 1.0f;
+
+			mMatrix[row * 4 + 0] = axis[0] / length;
+			mMatrix[row * 4 + 1] = axis[1] / length;
+			mMatrix[row * 4 + 2] = axis[2] / length;
+			mMatrix[row * 4 + 3] = 0.0f;
+		}
+		mMatrix[12] = matrix[12];
+		mMatrix[13] = matrix[13];
+		mMatrix[14] = matrix[14];
+		mMatrix[15] = 1.0f;
 	}
 
 	/********************************
@@ -103,22 +401,65 @@ namespace tle
 		return mLife < 0.0f;
 	}
 
+	//Returns the next particle in the list the particle is in
+	CParticle* CParticle::GetNext()
+	{
+		return mpNext;
+	}
+
+	//Returns the particle's position
+	CVector3 CParticle::GetPosition()
+	{
+		return CVector3(mMatrix[12], mMatrix[13], mMatrix[14]);
+	}
+
+	//Returns the particle's scale
+	float CParticle::GetScale()
+	{
+		return mScale * mCurveScale;
+	}
+
+	//Returns the quad the particle is shown with, or null if the particle has none
+	//Flipbook particles return null as their quads can't be handed to other particles
+	IModel* CParticle::GetSortableModel()
+	{
+		if (!mFrameModels.empty()) return 0;
+		return mpModel;
+	}
+
+	//Returns the texture id of the particle's quad
+	int CParticle::GetModelTexture()
+	{
+		return mModelTexture;
+	}
+
+	//Returns the order the particle's quad was created in
+	int CParticle::GetModelOrder()
+	{
+		return mModelOrder;
+	}
+
+	/********************************
+				  Sorting
+	*********************************/
+
+	//Gives the particle another quad with the same texture to be shown with
+	//Used to reorder which particle each quad shows as quads are drawn in a fixed order
+	void CParticle::SwapModel(const SParticleModel& model)
+	{
+		if (model.mpModel == mpModel) return;
+
+		mpModel = model.mpModel;
+		mModelOrder = model.mOrder;
+		Apply();
+	}
+
 	/********************************
 			Destroyer of worlds
 	*********************************/
 
 	CParticle::~CParticle()
 	{
-		//If there's a model then return it
-		if (mpModel)
-		{
-			//Get the relavent texture for the model
-			string texture = PARTICLE_TEXTURE;
-			if (static_cast<int>(mpData->mTexture.size()) > mTextureIndex)
-			{
-				texture = mpData->mTexture[mTextureIndex];
-			}
-			mpEngine->ReturnParticleModel(mpModel, texture);
-		}
+		ReleaseModel();
 	}
 }
\ No newline at end of file
@@ -6,6 +6,21 @@ namespace tle
 	//Hacky work around to avoid circular reference
 	class ExEngine;
 
+	//Number of samples over-life curves are baked into
+	const int kCurveSamples = 32;
+
+	//Most planes and spheres each emitter's particles can collide with
+	const int kMaxColliders = 4;
+
+	//A plane or sphere particles collide with, in world space
+	struct SCollider
+	{
+		CVector3 mVector; //Normal of a plane or centre of a sphere
+		float mValue; //Distance of a plane from the origin along its normal or radius of a sphere
+		bool mKill; //Kill particles that hit instead of bouncing them
+		float mBounciness; //Fraction of the speed into the collider that is kept
+	};
+
 	struct ParticleData
 	{
 	public:
@@ -14,44 +29,139 @@ namespace tle
 		float mAnimationRate; //Only used if there are multiple textures
 		CVector3 mVel;
 		CVector3 mAcl;
-		std::vector<string> mTexture;
+		std::vector<int> mTexture; //Texture ids interned by the engine, one per frame of the animation
+		bool mFlipbook; //Particles hold a quad for every frame instead of swapping quads when the frame changes
+
+		//Over-life curves, the keys as they were given and baked into evenly spaced samples from birth to death
+		//Empty keys turn the curve off
+		std::vector<float> mScaleKeys;
+		std::vector<float> mDragKeys;
+		float mScaleCurve[kCurveSamples]; //Multiplier of the particle scale
+		float mDragCurve[kCurveSamples]; //Fraction of the velocity lost per second
+
+		//Fixed size so every particle pays at most the same small cost
+		SCollider mPlanes[kMaxColliders];
+		SCollider mSpheres[kMaxColliders];
+		int mNumPlanes;
+		int mNumSpheres;
 	};
 
+	//A particle quad and the order it was created in
+	//Quads are drawn in the order they were created so the order travels with the quad for sorting
+	struct SParticleModel
+	{
+		IModel* mpModel;
+		int mOrder;
+	};
+
+	//Bakes keys spread evenly over a particle's life into the samples of a curve
+	//Values between the keys are interpolated linearly
+	void BakeCurve(const std::vector<float>& keys, float* samples);
+
 	class CParticle
 	{
 	private:
 		float mLife;
 		CVector3 mVel;
 		IModel* mpModel;
+		int mModelTexture; //Texture id of the model, kept separately so it stays correct if the skin changes
+		int mModelOrder; //Order the model was created in
+
+		//Flipbook particles hold a quad for every frame, only the quad of the current frame is shown
+		//mpModel points at the shown quad
+		std::vector<SParticleModel> mFrameModels;
+		std::vector<int> mFrameTextures;
+		int mShownFrame;
 		ParticleData* mpData;
 		float mTextureTimer;
 		int mTextureIndex;
 
+		//The particle's own copy of its transform so it can be simulated away from the TL-Engine
+		//Rows 0-2 are the unit local axes and row 3 the position, the scale is applied when copied to the model
+		float mMatrix[16];
+		float mScale;
+		float mCurveScale; //Multiplier from the scale curve at the particle's age
+
 		ExEngine* mpEngine;
 
+		//Intrusive links used by the particle pool
+		//A particle is either on the pool's active list or its free list
+		CParticle* mpNext;
+		CParticle* mpPrev;
+
+		friend class CParticlePool;
+
+		//Makes the quad of the current frame the particle's model, the quad of the last frame shown is hidden
+		//by HideFrames when the scene is next drawn
+		//Takes a quad for every frame the first time, or after the skin has changed
+		void ShowFrame();
+
+		//Reflects the part of the velocity heading into the surface with the given world space normal
+		void Reflect(const CVector3& normal, float bounciness);
+
 	public:
-		//Creates a particle model from the mesh
-		CParticle(ParticleData* data, ExEngine* engine);
+		//Creates an unused particle
+		//A model is only taken from the engine the first time the particle is reset
+		CParticle();
+
+		//Sets the shared particle data and the engine the particle's models come from
+		virtual void Init(ParticleData* data, ExEngine* engine);
 
 		/********************************
 				  Control stuff
 		*********************************/
 
 		//Updates the particle velocity, life, and location
+		//Only touches the particle itself so particles of different emitters can be updated on different threads
+		//Collisions aren't tested, the emitter tests its particles in batches after updating them
 		virtual void Update(float delta);
 
+		//Pushes the particle out of any collider it has moved into and bounces or kills it
+		//Emitters test their particles in batches, this is for a single particle such as one that has just spawned
+		void Collide();
+
+		//Bounces the particle off a plane it is the distance behind, or kills it
+		//Returns true if the particle was killed
+		bool HitPlane(const SCollider& plane, float distance);
+
+		//Bounces the particle off a sphere it is inside of, the distance squared from its centre, or kills it
+		//Returns true if the particle was killed
+		bool HitSphere(const SCollider& sphere, float distanceSquared);
+
 		//Reset the velocity and health of the particle
+		//Only touches the particle itself, the model is swapped on the next apply
 		virtual void Reset();
 
+		//Cuts the particle's remaining life to at most the given time
+		virtual void LimitLife(float life);
+
+		//Copies the particle's transform to its model, swapping the model if the frame of the animation has changed
+		//Calls into the TL-Engine so must only be called from the main thread
+		virtual void Apply();
+
+		//Takes a model for the first frame of the animation from the engine if the particle doesn't have one
+		//Flipbook particles take a model for every frame
+		virtual void PrepareModel();
+
 		//Hides the particle at the position specified
+		//Flipbook particles hide the quad of every frame
 		virtual void HideAt(CVector3& position);
 
+		//Hides the quads of the frames a flipbook particle isn't showing at the position specified
+		//Moved out of view rather than shrunk so the TL-Engine culls them instead of drawing them
+		virtual void HideFrames(CVector3& position);
+
+		//Returns the particle's model, or every model of a flipbook particle, to the engine
+		//A new model will be taken the next time the particle is reset
+		virtual void ReleaseModel();
+
 		/********************************
 					   Sets
 		*********************************/
 
 		//Sets the particle's position/rotation matrix
-		virtual void SetMatrix(float* matrix);
+		//Any scale in the matrix is removed
+		virtual void SetMatrix(const float* matrix);
 
 		/********************************
 					   Gets
@@ -60,6 +170,33 @@ namespace tle
 		//Checks if the particle is dead
 		virtual bool IsDead();
 
+		//Returns the next particle in the list the particle is in
+		CParticle* GetNext();
+
+		//Returns the particle's position
+		CVector3 GetPosition();
+
+		//Returns the particle's scale
+		float GetScale();
+
+		//Returns the quad the particle is shown with, or null if the particle has none
+		//Flipbook particles return null as their quads can't be handed to other particles
+		IModel* GetSortableModel();
+
+		//Returns the texture id of the particle's quad
+		int GetModelTexture();
+
+		//Returns the order the particle's quad was created in
+		int GetModelOrder();
+
+		/********************************
+					  Sorting
+		*********************************/
+
+		//Gives the particle another quad with the same texture to be shown with
+		//Used to reorder which particle each quad shows as quads are drawn in a fixed order
+		void SwapModel(const SParticleModel& model);
+
 		/********************************
 			   Destroyer of worlds
 		*********************************/
@@ -1,27 +1,44 @@
 #include "stdafx.h"
 #include "CParticleEmitter.h"
+#include "CEmitterTemplate.h"
 #include "ExEngine.h"
+#include <cmath>
 
 namespace tle
 {
-	CParticleEmitter::CParticleEmitter(EEmissionType type, float rate, tlx::ICamera* positionNode, tlx::ISceneManager* sceneManager, ExEngine* engine) : CTLXSceneNode(positionNode)
+	CParticleEmitter::CParticleEmitter(EEmissionType type, float rate, ExEngine* engine)
+		: mpParticleData(std::make_shared<ParticleData>()), mPool(mpParticleData.get(), engine)
 	{
 		mType = type;
 
-		mParticleData.mMaxLife = 0.0f;
-		mParticleData.mScale = 1.0f;
-		mParticleData.mAnimationRate = 1.0f;
-		mParticleData.mVel = CVector3(0.0f, 0.0f, 0.0f);
-		mParticleData.mAcl = CVector3(0.0f, 0.0f, 0.0f);
-		mParticleData.mTexture = vector<string>(1, PARTICLE_TEXTURE);
+		mpParticleData->mMaxLife = 0.0f;
+		mpParticleData->mScale = 1.0f;
+		mpParticleData->mAnimationRate = 1.0f;
+		mpParticleData->mVel = CVector3(0.0f, 0.0f, 0.0f);
+		mpParticleData->mAcl = CVector3(0.0f, 0.0f, 0.0f);
+		mpParticleData->mFlipbook = false;
+		mpParticleData->mNumPlanes = 0;
+		mpParticleData->mNumSpheres = 0;
+		mpParticleData->mTexture = vector<int>(1, engine->GetTextureId(PARTICLE_TEXTURE));
+		mpTemplate = 0;
 
 		mRate = rate;
+		mAngle = 0.0f;
 		mTimer = 0.0f;
 		mPaused = false;
+		mDrained = false;
+
+		//Unseeded emitters differ from run to run
+		SetRandomSeed(static_cast<unsigned int>(reinterpret_cast<uintptr_t>(this) >> 4));
+		mFixedStep = 0.0f;
+		mStepTimer = 0.0f;
 
-		mpSceneManager = sceneManager;
-		mpTLXCamera = positionNode;
 		mpEngine = engine;
+
+		for (int i = 0; i < 16; ++i)
+		{
+			mSpawnMatrix[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+		}
 	}
 
 	/************************************
@@ -43,38 +60,137 @@ namespace tle
 	//Sets all particles to the despawned (inactive) state
 	void CParticleEmitter::Reset()
 	{
-		//Todo
+		//The particles keep their models so they can be spawned again without going through the engine
+		mPool.KillAll();
+		mTimer = 0.0f;
+		mStepTimer = 0.0f;
+	}
+
+	//Cuts the remaining life of every active particle to at most the given time in seconds
+	void CParticleEmitter::LimitParticleLife(float life)
+	{
+		for (CParticle* particle = mPool.GetFirstActive(); particle; particle = particle->GetNext())
+		{
+			particle->LimitLife(life);
+		}
 	}
 
 	//Clears local cache of particles
 	//Returns all particles back to the engine
 	void CParticleEmitter::Clear()
 	{
-		//Return all active particles
-		mActive.clear();
+		//Return all active and inactive particles
+		mPool.Clear();
+	}
+
+	//Allocates enough particles for the amount to be alive at once and gives them their models up front
+	//Also fills the model cache with quads for every texture of an animated skin
+	//An amount of 0 or less reserves enough for the current emission rate and particle life
+	void CParticleEmitter::Reserve(int amount)
+	{
+		if (amount <= 0)
+		{
+			if (mRate <= FASTEST_EMISSION_RATE) return;
+			amount = static_cast<int>(mpParticleData->mMaxLife / mRate) + 1;
+		}
+
+		//Particles start on the first frame so they take those models themselves
+		mPool.Reserve(amount);
+
+		//Flipbook particles already took a model for every frame
+		if (mpParticleData->mFlipbook) return;
+
+		//At a steady state the particles are spread evenly over the frames of the animation
+		//so the cache needs a share of the particles for each of the later frames
+		const int frames = static_cast<int>(mpParticleData->mTexture.size());
+		const int perFrame = amount / frames + 1;
+		for (int i = 1; i < frames; ++i)
+		{
+			mpEngine->ReserveParticleModels(mpParticleData->mTexture[i], perFrame);
+		}
+	}
+
+	//Simulates the emitter for the given amount of time so it starts at a steady state
+	//A time of 0 or less simulates a single particle life time
+	void CParticleEmitter::PreWarm(float time)
+	{
+		//Step at the same rate as a 60fps frame as particle movement is applied per update
+		const float step = 1.0f / 60.0f;
 
-		//Return all inactive particles
-		mInactive.clear();
+		if (time <= 0.0f) time = mpParticleData->mMaxLife;
+
+		for (; time > 0.0f; time -= step)
+		{
+			Update(time < step ? time : step);
+		}
 	}
 
-	//Do not call
 	//Called from the engine to auto update the particles and emitter
+	//Runs all three of the update phases below
 	void CParticleEmitter::Update(float delta)
 	{
-		//Update particles and remove those that are dead
-		for (auto particle = mActive.begin(); particle != mActive.end(); /*Only iterate if no erase occurs*/)
+		PrepareUpdate();
+		Simulate(delta);
+		ApplyUpdate();
+	}
+
+	//Do not call
+	//First phase of the update, stores everything needed from the TL-Engine to simulate the particles
+	void CParticleEmitter::PrepareUpdate()
+	{
+		//Resolves the parent's matrix if the emitter is attached
+		GetMatrix(mSpawnMatrix);
+	}
+
+	//Do not call
+	//Second phase of the update, moves, spawns and kills particles without calling into the TL-Engine
+	void CParticleEmitter::Simulate(float delta)
+	{
+		if (mFixedStep <= 0.0f)
+		{
+			Step(delta);
+			return;
+		}
+
+		mStepTimer += delta;
+		while (mStepTimer >= mFixedStep)
+		{
+			mStepTimer -= mFixedStep;
+			Step(mFixedStep);
+		}
+	}
+
+	//Moves, spawns and kills particles for a single step of time
+	void CParticleEmitter::Step(float delta)
+	{
+		const bool collide = mpParticleData->mNumPlanes > 0 || mpParticleData->mNumSpheres > 0;
+		SCollisionBatch batch;
+		batch.mCount = 0;
+
+		//Update particles and return those that are dead to the pool
+		//Those left alive are gathered into batches to be tested for collision
+		for (CParticle* particle = mPool.GetFirstActive(); particle; /*Next is fetched before a kill can relink it*/)
 		{
-			(*particle)->Update(delta);
-			if ((*particle)->IsDead())
+			CParticle* next = particle->GetNext();
+
+			particle->Update(delta);
+			if (particle->IsDead())
 			{
-				mInactive.push_back(move(*particle));
-				particle = mActive.erase(particle);
+				mPool.Kill(particle);
 			}
-			else
+			else if (collide)
 			{
-				++particle;
+				CVector3 position = particle->GetPosition();
+				batch.mpParticles[batch.mCount] = particle;
+				batch.mX[batch.mCount] = position.x;
+				batch.mY[batch.mCount] = position.y;
+				batch.mZ[batch.mCount] = position.z;
+				if (++batch.mCount == kCollisionBatch) CollideBatch(batch);
 			}
+
+			particle = next;
 		}
+		if (batch.mCount > 0) CollideBatch(batch);
 
 		//Update spawning if not paused
 		//Also don't spawn anything if the spawn rate is faster than the limit
@@ -85,38 +201,269 @@ namespace tle
 			{
 				do {
 					mTimer -= mRate;
-				} while (mTimer >= mParticleData.mMaxLife); //No point in making a particle that is already dead
+				} while (mTimer >= mpParticleData->mMaxLife); //No point in making a particle that is already dead
+
+				//Get an unused particle, the pool only allocates when it has run out
+				CParticle* particle = mPool.Spawn();
+				particle->Reset();
 
-				CParticle* particle;
+				//Set particle data and location
 				float matrix[16];
-				GetMatrix(matrix);
-				matrix[12] = GetX();
-				matrix[13] = GetY();
-				matrix[14] = GetZ();
+				GetEmissionMatrix(matrix);
+				particle->SetMatrix(matrix);
+
+				//Move it by the amount of time passed since it should of been created
+				particle->Update(mTimer);
+				if (collide) particle->Collide();
+			}
+		}
+	}
+
+	//Tests the batch against every plane then every sphere, bouncing or killing the particles that hit
+	//Empties the batch
+	void CParticleEmitter::CollideBatch(SCollisionBatch& batch)
+	{
+		const ParticleData* data = mpParticleData.get();
+		const int count = batch.mCount;
+
+		for (int i = 0; i < data->mNumPlanes; ++i)
+		{
+			const SCollider& plane = data->mPlanes[i];
+			const float x = plane.mVector.x, y = plane.mVector.y, z = plane.mVector.z, d = plane.mValue;
+			for (int p = 0; p < count; ++p)
+			{
+				batch.mTest[p] = batch.mX[p] * x + batch.mY[p] * y + batch.mZ[p] * z - d;
+			}
+
+			for (int p = 0; p < count; ++p)
+			{
+				CParticle* particle = batch.mpParticles[p];
+				if (batch.mTest[p] >= 0.0f || !particle) continue;
 
-				//Get an unused particle
-				if (mInactive.size() > 0)
+				if (particle->HitPlane(plane, batch.mTest[p]))
 				{
-					particle = mInactive.back().release();
-					mInactive.pop_back();
-					particle->Reset();
+					mPool.Kill(particle);
+					batch.mpParticles[p] = 0;
+					continue;
 				}
-				else
+
+				//The later colliders test where it has been pushed to
+				CVector3 position = particle->GetPosition();
+				batch.mX[p] = position.x;
+				batch.mY[p] = position.y;
+				batch.mZ[p] = position.z;
+			}
+		}
+
+		for (int i = 0; i < data->mNumSpheres; ++i)
+		{
+			const SCollider& sphere = data->mSpheres[i];
+			const float x = sphere.mVector.x, y = sphere.mVector.y, z = sphere.mVector.z;
+			const float radiusSquared = sphere.mValue * sphere.mValue;
+			for (int p = 0; p < count; ++p)
+			{
+				float dx = batch.mX[p] - x, dy = batch.mY[p] - y, dz = batch.mZ[p] - z;
+				batch.mTest[p] = dx * dx + dy * dy + dz * dz;
+			}
+
+			for (int p = 0; p < count; ++p)
+			{
+				CParticle* particle = batch.mpParticles[p];
+				if (batch.mTest[p] >= radiusSquared || !particle) continue;
+
+				if (particle->HitSphere(sphere, batch.mTest[p]))
 				{
-					particle = new CParticle(&mParticleData, mpEngine);
+					mPool.Kill(particle);
+					batch.mpParticles[p] = 0;
+					continue;
 				}
 
-				//Set particle data and location
-				particle->SetMatrix(matrix);
+				CVector3 position = particle->GetPosition();
+				batch.mX[p] = position.x;
+				batch.mY[p] = position.y;
+				batch.mZ[p] = position.z;
+			}
+		}
 
-				//Move it by the amount of time passed since it should of been created
-				particle->Update(mTimer);
+		batch.mCount = 0;
+	}
+
+	//Returns a random float from 0 to 1 from the emitter's generator
+	//A xorshift generator, small enough to keep one per emitter and the same on every platform
+	float CParticleEmitter::Random()
+	{
+		mRandomState ^= mRandomState << 13;
+		mRandomState ^= mRandomState >> 17;
+		mRandomState ^= mRandomState << 5;
+		return static_cast<float>(mRandomState >> 8) / 16777216.0f;
+	}
+
+	//Writes the matrix a new particle is emitted with into the given matrix
+	//Particles move along their local axes, so the emitter's axes are rotated by the turn that takes the
+	//direction of the particle velocity to a random direction picked by the emission type and angle
+	void CParticleEmitter::GetEmissionMatrix(float* matrix)
+	{
+		const float kPi = 3.14159265f;
+		const float angle = mAngle * kPi / 180.0f;
+
+		//Direction relative to the velocity, z is along the velocity and x and y are across it
+		float emit[3] = { 0.0f, 0.0f, 1.0f };
+		switch (mType)
+		{
+		case Sphere:
+		{
+			float z = Random() * 2.0f - 1.0f;
+			float around = Random() * 2.0f * kPi;
+			float radius = sqrtf(1.0f - z * z);
+			emit[0] = radius * cosf(around);
+			emit[1] = radius * sinf(around);
+			emit[2] = z;
+			break;
+		}
+		case Circle: //A ring at right angles to the velocity
+		{
+			float around = Random() * 2.0f * kPi;
+			emit[0] = cosf(around);
+			emit[1] = sinf(around);
+			emit[2] = 0.0f;
+			break;
+		}
+		case Cone:
+		{
+			//Uniform over the cap of the sphere within the angle of the velocity
+			float z = 1.0f - Random() * (1.0f - cosf(angle));
+			float around = Random() * 2.0f * kPi;
+			float radius = sqrtf(1.0f - z * z);
+			emit[0] = radius * cosf(around);
+			emit[1] = radius * sinf(around);
+			emit[2] = z;
+			break;
+		}
+		case Arch: //A fan within the angle of the velocity, turning towards the emitter's x axis
+		{
+			float around = (Random() - 0.5f) * angle;
+			emit[0] = sinf(around);
+			emit[2] = cosf(around);
+			break;
+		}
+		default: //Line
+			break;
+		}
+
+		//Direction of the velocity in the emitter's space, particles with no velocity are turned from the z axis
+		const CVector3& vel = mpParticleData->mVel;
+		float forward[3] = { vel.x, vel.y, vel.z };
+		float speed = sqrtf(forward[0] * forward[0] + forward[1] * forward[1] + forward[2] * forward[2]);
+		if (speed > 0.0f)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				forward[i] /= speed;
+			}
+		}
+		else
+		{
+			forward[0] = 0.0f;
+			forward[1] = 0.0f;
+			forward[2] = 1.0f;
+		}
+
+		//Axes across the velocity, using the emitter's x axis unless it is too close to the velocity
+		float across[3] = { 1.0f, 0.0f, 0.0f };
+		if (fabsf(forward[0]) > 0.99f)
+		{
+			across[0] = 0.0f;
+			across[1] = 1.0f;
+		}
+		float along = across[0] * forward[0] + across[1] * forward[1] + across[2] * forward[2];
+		float length = 0.0f;
+		for (int i = 0; i < 3; ++i)
+		{
+			across[i] -= forward[i] * along;
+			length += across[i] * across[i];
+		}
+		length = sqrtf(length);
+		for (int i = 0; i < 3; ++i)
+		{
+			across[i] /= length;
+		}
+		float across2[3] = { forward[1] * across[2] - forward[2] * across[1], forward[2] * across[0] - forward[0] * across[2], forward[0] * across[1] - forward[1] * across[0] };
+
+		float dir[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			dir[i] = emit[0] * across[i] + emit[1] * across2[i] + emit[2] * forward[i];
+		}
+
+		//Turn taking the velocity's direction to the emitted direction about the axis at right angles to both
+		float axis[3] = { forward[1] * dir[2] - forward[2] * dir[1], forward[2] * dir[0] - forward[0] * dir[2], forward[0] * dir[1] - forward[1] * dir[0] };
+		float sine = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+		float cosine = forward[0] * dir[0] + forward[1] * dir[1] + forward[2] * dir[2];
+		if (sine > 0.0001f)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				axis[i] /= sine;
+			}
+		}
+		else
+		{
+			//Already along the velocity, or straight back along it which is a half turn about any axis across it
+			for (int i = 0; i < 3; ++i)
+			{
+				axis[i] = across[i];
+			}
+			sine = 0.0f;
+			cosine = cosine > 0.0f ? 1.0f : -1.0f;
+		}
+
+		//Rotate each of the emitter's axes, then take them to world space
+		for (int row = 0; row < 3; ++row)
+		{
+			float unit[3] = { 0.0f, 0.0f, 0.0f };
+			unit[row] = 1.0f;
+
+			float onAxis = axis[row];
+			float local[3];
+			for (int i = 0; i < 3; ++i)
+			{
+				float cross = axis[(i + 1) % 3] * unit[(i + 2) % 3] - axis[(i + 2) % 3] * unit[(i + 1) % 3];
+				local[i] = unit[i] * cosine + cross * sine + axis[i] * onAxis * (1.0f - cosine);
+			}
 
-				mActive.push_back(std::unique_ptr<CParticle>(particle));
+			for (int i = 0; i < 3; ++i)
+			{
+				matrix[row * 4 + i] = local[0] * mSpawnMatrix[i] + local[1] * mSpawnMatrix[4 + i] + local[2] * mSpawnMatrix[8 + i];
 			}
+			matrix[row * 4 + 3] = 0.0f;
+		}
+		for (int i = 12; i < 16; ++i)
+		{
+			matrix[i] = mSpawnMatrix[i];
+		}
+	}
+
+	//Do not call
+	//Last phase of the update, copies the particles to their models
+	void CParticleEmitter::ApplyUpdate()
+	{
+		for (CParticle* particle = mPool.GetFirstActive(); particle; particle = particle->GetNext())
+		{
+			particle->Apply();
 		}
 	}
 
+	//Do not call
+	//Returns true once when the emitter is stopped and its last particle has died
+	//Called from the engine after the update to queue drained events
+	bool CParticleEmitter::CheckDrained()
+	{
+		bool drained = mPaused && mPool.GetActiveCount() == 0;
+		bool justDrained = drained && !mDrained;
+		mDrained = drained;
+		return justDrained;
+	}
+
 	//Do not call
 	//Called from the engine to orientate the particles
 	//To either face or hide behind the camera
@@ -140,12 +487,46 @@ namespace tle
 					 (matrix[1] * -100.0f) + camera->GetY(),
 					 (matrix[2] * -100.0f) + camera->GetZ());
 
-		for (auto particle = mInactive.begin(); particle != mInactive.end(); ++particle)
+		for (CParticle* particle = mPool.GetFirstFree(); particle; particle = particle->GetNext())
+		{
+			particle->HideAt(pos);
+		}
+
+		//Flipbook particles hold quads of frames they aren't showing, which are hidden with the free particles
+		if (mpParticleData->mFlipbook)
 		{
-			(*particle)->HideAt(pos);
+			for (CParticle* particle = mPool.GetFirstActive(); particle; particle = particle->GetNext())
+			{
+				particle->HideFrames(pos);
+			}
 		}
 	}
 
+	/************************************
+				Determinism
+	*************************************/
+
+	//Restarts the emitter's random number generator from the seed
+	void CParticleEmitter::SetRandomSeed(unsigned int seed)
+	{
+		//The generator never leaves zero so nudge it
+		mRandomState = seed ? seed : 0x9E3779B9u;
+	}
+
+	//Simulates the emitter in fixed steps of the given time in seconds
+	//A step of 0 or less simulates with the delta given to each update
+	void CParticleEmitter::SetFixedTimestep(float step)
+	{
+		mFixedStep = step > 0.0f ? step : 0.0f;
+		mStepTimer = 0.0f;
+	}
+
+	//Returns the fixed step the emitter is simulated with, 0 if it uses the update delta
+	float CParticleEmitter::GetFixedTimestep()
+	{
+		return mFixedStep;
+	}
+
 	/************************************
 					Sets
 	*************************************/
@@ -167,37 +548,136 @@ namespace tle
 
 	void CParticleEmitter::SetParticleLife(float life)
 	{
-		mParticleData.mMaxLife = life;
-		mParticleData.mAnimationRate = life / static_cast<int>(mParticleData.mTexture.size());
+		ParticleData* data = EditParticleData();
+		data->mMaxLife = life;
+		data->mAnimationRate = life / static_cast<int>(data->mTexture.size());
 	}
 
 	void CParticleEmitter::SetParticleSkin(const string& skin)
 	{
-		mParticleData.mTexture.clear();
-		mParticleData.mTexture.push_back(skin);
-		mParticleData.mAnimationRate = mParticleData.mMaxLife;
+		//Dead particles hold models with the old skin, hand them back while the old texture names are known
+		mPool.ReleaseFreeModels();
+
+		ParticleData* data = EditParticleData();
+		data->mTexture.clear();
+		data->mTexture.push_back(mpEngine->GetTextureId(skin));
+		data->mAnimationRate = data->mMaxLife;
 	}
 
 	//Set the texture used for the particle's quad model
 	void CParticleEmitter::SetParticleSkin(const std::vector<string>& skin)
 	{
-		mParticleData.mAnimationRate = mParticleData.mMaxLife / static_cast<int>(skin.size());
-		mParticleData.mTexture = skin;
+		//Dead particles hold models with the old skin, hand them back while the old texture names are known
+		mPool.ReleaseFreeModels();
+
+		ParticleData* data = EditParticleData();
+		data->mAnimationRate = data->mMaxLife / static_cast<int>(skin.size());
+		data->mTexture.clear();
+		for (auto texture = skin.begin(); texture != skin.end(); ++texture)
+		{
+			data->mTexture.push_back(mpEngine->GetTextureId(*texture));
+		}
 	}
 	
 	void CParticleEmitter::SetParticleVelocity(const CVector3& vel)
 	{
-		mParticleData.mVel = vel;
+		EditParticleData()->mVel = vel;
 	}
 	
 	void CParticleEmitter::SetParticleAcceleration(const CVector3& acl)
 	{
-		mParticleData.mAcl = acl;
+		EditParticleData()->mAcl = acl;
 	}
 	
 	void CParticleEmitter::SetParticleScale(float scale)
 	{
-		mParticleData.mScale = scale;
+		EditParticleData()->mScale = scale;
+	}
+
+	void CParticleEmitter::SetParticleFlipbook(bool flipbook)
+	{
+		EditParticleData()->mFlipbook = flipbook;
+	}
+
+	void CParticleEmitter::SetParticleScaleCurve(const std::vector<float>& keys)
+	{
+		ParticleData* data = EditParticleData();
+		data->mScaleKeys = keys;
+		BakeCurve(keys, data->mScaleCurve);
+	}
+
+	void CParticleEmitter::SetParticleDragCurve(const std::vector<float>& keys)
+	{
+		ParticleData* data = EditParticleData();
+		data->mDragKeys = keys;
+		BakeCurve(keys, data->mDragCurve);
+	}
+
+	/************************************
+					Collision
+	*************************************/
+
+	bool CParticleEmitter::AddCollisionPlane(const CVector3& point, const CVector3& normal, ECollisionResponse response, float bounciness)
+	{
+		float length = sqrtf(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+		if (length == 0.0f || mpParticleData->mNumPlanes >= kMaxColliders) return false;
+
+		ParticleData* data = EditParticleData();
+		SCollider& plane = data->mPlanes[data->mNumPlanes++];
+		plane.mVector = CVector3(normal.x / length, normal.y / length, normal.z / length);
+		plane.mValue = point.x * plane.mVector.x + point.y * plane.mVector.y + point.z * plane.mVector.z;
+		plane.mKill = response == Kill;
+		plane.mBounciness = bounciness;
+		return true;
+	}
+
+	bool CParticleEmitter::AddCollisionSphere(const CVector3& centre, float radius, ECollisionResponse response, float bounciness)
+	{
+		if (radius <= 0.0f || mpParticleData->mNumSpheres >= kMaxColliders) return false;
+
+		ParticleData* data = EditParticleData();
+		SCollider& sphere = data->mSpheres[data->mNumSpheres++];
+		sphere.mVector = centre;
+		sphere.mValue = radius;
+		sphere.mKill = response == Kill;
+		sphere.mBounciness = bounciness;
+		return true;
+	}
+
+	void CParticleEmitter::ClearCollision()
+	{
+		ParticleData* data = EditParticleData();
+		data->mNumPlanes = 0;
+		data->mNumSpheres = 0;
+	}
+
+	//////////////
+	//Attachment//
+
+	//Attaches the emitter to the scene node so it follows the node without being moved every frame
+	//The emitter's matrix becomes relative to the node, the node's matrix is read once each update
+	void CParticleEmitter::AttachTo(ISceneNode* parent, const CVector3& offset)
+	{
+		DetachFromParent();
+		SetPosition(offset.x, offset.y, offset.z);
+		AttachToParent(parent);
+	}
+
+	//Detaches the emitter from the scene node it was attached to
+	void CParticleEmitter::Detach()
+	{
+		DetachFromParent();
+	}
+
+	//Do not call
+	//Detaches the emitter when it is removed without reading the node, which may have been removed first
+	//The emitter stays where it was at the last update
+	void CParticleEmitter::ReleaseParent()
+	{
+		if (!GetParent()) return;
+
+		ClearParent();
+		SetMatrix(mSpawnMatrix);
 	}
 
 	/************************************
@@ -221,28 +701,43 @@ namespace tle
 
 	float CParticleEmitter::GetParticleLife()
 	{
-		return mParticleData.mMaxLife;
+		return mpParticleData->mMaxLife;
 	}
 
 	string CParticleEmitter::GetParticleSkin()
 	{
 		//Assumes that there is always at least one texture
-		return mParticleData.mTexture[0];
+		return mpEngine->GetTextureName(mpParticleData->mTexture[0]);
 	}
 
 	CVector3 CParticleEmitter::GetParticleVelocity()
 	{
-		return mParticleData.mVel;
+		return mpParticleData->mVel;
 	}
 
 	CVector3 CParticleEmitter::GetParticleAcceleration()
 	{
-		return mParticleData.mAcl;
+		return mpParticleData->mAcl;
 	}
 
 	float CParticleEmitter::GetParticleScale()
 	{
-		return mParticleData.mScale;
+		return mpParticleData->mScale;
+	}
+
+	bool CParticleEmitter::GetParticleFlipbook()
+	{
+		return mpParticleData->mFlipbook;
+	}
+
+	std::vector<float> CParticleEmitter::GetParticleScaleCurve()
+	{
+		return mpParticleData->mScaleKeys;
+	}
+
+	std::vector<float> CParticleEmitter::GetParticleDragCurve()
+	{
+		return mpParticleData->mDragKeys;
 	}
 
 	//Returns true is the emitter is emitting particles
@@ -254,7 +749,112 @@ namespace tle
 	//Returns true if one or more of the emitter particles are still active
 	bool CParticleEmitter::HasActiveParticles()
 	{
-		return mActive.size() > 0;
+		return mPool.GetActiveCount() > 0;
+	}
+
+	/************************************
+				Templates
+	*************************************/
+
+	//Replaces the emitter and particle settings with those of the template
+	//Any active particles are reset
+	void CParticleEmitter::ApplyTemplate(CEmitterTemplate* emitterTemplate)
+	{
+		const SEmitterSettings& settings = emitterTemplate->GetSettings();
+
+		Reset();
+
+		mpTemplate = emitterTemplate;
+		mType = settings.mType;
+		mRate = settings.mEmissionRate;
+		mAngle = settings.mEmissionAngle;
+		mTimer = 0.0f;
+		mPaused = false;
+
+		//Point the particles at the template's data, the old data is released if nothing else shares it
+		if (mpParticleData != emitterTemplate->GetParticleData())
+		{
+			mpParticleData = emitterTemplate->GetParticleData();
+			mPool.SetData(mpParticleData.get());
+		}
+
+		ResetOrientation();
+	}
+
+	//Returns the template the emitter was spawned from, or null
+	CEmitterTemplate* CParticleEmitter::GetTemplate()
+	{
+		return mpTemplate;
+	}
+
+	//Forgets the template, called when the template is removed
+	void CParticleEmitter::ClearTemplate()
+	{
+		mpTemplate = 0;
+	}
+
+	//Prepares the emitter to sit idle in its template's pool
+	//Dead particles hand their models back to the engine as idle emitters aren't orientated
+	void CParticleEmitter::Park()
+	{
+		mPool.KillAll();
+		mPool.ReleaseFreeModels();
+		mTimer = 0.0f;
+	}
+
+	//Returns particle data that is safe to modify
+	//Copies the data first if it is shared with a template
+	ParticleData* CParticleEmitter::EditParticleData()
+	{
+		if (mpParticleData.use_count() > 1)
+		{
+			mpParticleData = std::make_shared<ParticleData>(*mpParticleData);
+			mPool.SetData(mpParticleData.get());
+		}
+		return mpParticleData.get();
+	}
+
+	/************************************
+				Diagnostics
+	*************************************/
+
+	//Returns the first particle currently alive, use CParticle::GetNext to iterate
+	CParticle* CParticleEmitter::GetFirstActiveParticle()
+	{
+		return mPool.GetFirstActive();
+	}
+
+	//Returns the number of particles currently alive
+	int CParticleEmitter::GetActiveParticleCount()
+	{
+		return mPool.GetActiveCount();
+	}
+
+	//Returns the number of dead particles waiting to be reused
+	int CParticleEmitter::GetInactiveParticleCount()
+	{
+		return mPool.GetFreeCount();
+	}
+
+	//Returns an estimate of the memory held by the emitter and its particles in bytes
+	size_t CParticleEmitter::GetMemoryUsage()
+	{
+		size_t bytes = sizeof(CParticleEmitter);
+		bytes += mPool.GetCapacity() * sizeof(CParticle);
+
+		//Flipbook particles also keep a list of their quads
+		if (mpParticleData->mFlipbook)
+		{
+			bytes += mPool.GetCapacity() * mpParticleData->mTexture.size() * (sizeof(IModel*) + sizeof(int));
+		}
+
+		//Shared data is accounted for by the template
+		if (mpParticleData.use_count() == 1)
+		{
+			bytes += sizeof(ParticleData) + mpParticleData->mTexture.capacity() * sizeof(int);
+			bytes += (mpParticleData->mScaleKeys.capacity() + mpParticleData->mDragKeys.capacity()) * sizeof(float);
+		}
+		return bytes;
 	}
 
 	/************************************
@@ -263,7 +863,6 @@ namespace tle
 
 	CParticleEmitter::~CParticleEmitter()
 	{
-		mpSceneManager->RemoveCamera(mpTLXCamera);
 		Clear();
 	}
 }
\ No newline at end of file
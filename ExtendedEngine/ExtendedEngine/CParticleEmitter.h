@@ -1,16 +1,16 @@
 #pragma once
 #include "IParticleEmitter.h"
-#include "TLXSceneNode.h"
-#include "ISceneManager.h"
-#include "ICamera.h"
-#include "CParticle.h"
+#include "CTransformNode.h"
+#include "CParticlePool.h"
 
 namespace tle
 {
 	//Hacky work around to avoid circular reference
 	class ExEngine;
+	class CEmitterTemplate;
 
-	class CParticleEmitter : virtual public IParticleEmitter, public CTLXSceneNode
+	//Positioned by its own transform node so emitters add nothing to the TL-Engine's scene manager
+	class CParticleEmitter : virtual public IParticleEmitter, public CTransformNode
 	{
 	private:
 		//Emitter data
@@ -19,21 +19,62 @@ namespace tle
 		float mAngle;
 		float mTimer;
 		bool mPaused;
+		bool mDrained; //Set once the engine has been told the stopped emitter has no particles left
 
-		//Particle data
-		ParticleData mParticleData;
+		//Determinism
+		unsigned int mRandomState;
+		float mFixedStep;
+		float mStepTimer; //Time carried over to the next update when using a fixed step
+
+		//Particle data, shared with the emitter's template until a particle setting is changed
+		std::shared_ptr<ParticleData> mpParticleData;
+		CEmitterTemplate* mpTemplate;
 
-		//Shit
-		tlx::ISceneManager* mpSceneManager;
-		tlx::ICamera* mpTLXCamera;
 		ExEngine* mpEngine;
 
-		//Particle lists
-		list_ptr<CParticle> mInactive;
-		list_ptr<CParticle> mActive;
+		//Particle storage
+		CParticlePool mPool;
+
+		//Copy of the emitter's world matrix taken before the particles are simulated
+		//so spawning doesn't have to call into the parent it is attached to
+		float mSpawnMatrix[16];
+
+		//Most particles tested for collision at once, the same as a block of the particle pool
+		static const int kCollisionBatch = 64;
+
+		//Particles tested for collision together
+		//Their positions are laid out in arrays so each collider is tested against the whole batch in one loop
+		//the compiler can vectorise, only the particles that hit are bounced or killed one at a time
+		struct SCollisionBatch
+		{
+			CParticle* mpParticles[kCollisionBatch]; //Null once a particle has been killed
+			float mX[kCollisionBatch];
+			float mY[kCollisionBatch];
+			float mZ[kCollisionBatch];
+			float mTest[kCollisionBatch]; //Distance in front of a plane or distance squared from the centre of a sphere
+			int mCount;
+		};
+
+		//Moves, spawns and kills particles for a single step of time
+		void Step(float delta);
+
+		//Tests the batch against every plane then every sphere, bouncing or killing the particles that hit
+		//Empties the batch
+		void CollideBatch(SCollisionBatch& batch);
+
+		//Returns a random float from 0 to 1 from the emitter's generator
+		float Random();
+
+		//Writes the matrix a new particle is emitted with into the given matrix
+		//Rotates the emitter's axes by the turn taking the particle velocity to a random direction picked by the emission type and angle
+		void GetEmissionMatrix(float* matrix);
+
+		//Returns particle data that is safe to modify
+		//Copies the data first if it is shared with a template
+		ParticleData* EditParticleData();
 
 	public:
-		CParticleEmitter(EEmissionType type, float rate, tlx::ICamera* positionNode, tlx::ISceneManager* sceneManager, ExEngine* engine);
+		CParticleEmitter(EEmissionType type, float rate, ExEngine* engine);
 
 		/************************************
 				  Update Controls
@@ -46,21 +87,70 @@ namespace tle
 		virtual void Stop();
 
 		//Sets all particles to the despawned (inactive) state
+		//The particles keep their quads so restarting the emitter doesn't go back through the model cache
 		virtual void Reset();
 
+		//Cuts the remaining life of every active particle to at most the given time in seconds
+		virtual void LimitParticleLife(float life);
+
 		//Clears local cache of particles
 		//Returns all particles back to the engine
 		virtual void Clear();
 
-		//Do not call
+		//Allocates enough particles for the amount to be alive at once and gives them their models up front
+		//Also fills the model cache with quads for every texture of an animated skin
+		//An amount of 0 or less reserves enough for the current emission rate and particle life
+		//Call after setting the particle skin, life and emission rate
+		virtual void Reserve(int amount = 0);
+
+		//Simulates the emitter for the given amount of time so it starts at a steady state
+		//A time of 0 or less simulates a single particle life time
+		//Call after setting up the emitter, only spawns particles if the emitter is started
+		virtual void PreWarm(float time = 0.0f);
+
 		//Called from the engine to auto update the particles and emitter
+		//Runs all three of the update phases below
 		virtual void Update(float delta);
 
+		//Do not call
+		//First phase of the update, stores everything needed from the TL-Engine to simulate the particles
+		//Must be called from the main thread
+		void PrepareUpdate();
+
+		//Do not call
+		//Second phase of the update, moves, spawns and kills particles without calling into the TL-Engine
+		//Safe to call for different emitters on different threads at the same time
+		void Simulate(float delta);
+
+		//Do not call
+		//Last phase of the update, copies the particles to their models
+		//Must be called from the main thread
+		void ApplyUpdate();
+
+		//Do not call
+		//Returns true once when the emitter is stopped and its last particle has died
+		//Called from the engine after the update to queue drained events
+		bool CheckDrained();
+
 		//Do not call
 		//Called from the engine to orientate the particles
 		//To either face or hide behind the camera
 		virtual void OrientateParticles(ICamera* camera);
 		
+		/************************************
+					Determinism
+		*************************************/
+
+		//Restarts the emitter's random number generator from the seed
+		virtual void SetRandomSeed(unsigned int seed);
+
+		//Simulates the emitter in fixed steps of the given time in seconds
+		//A step of 0 or less simulates with the delta given to each update
+		virtual void SetFixedTimestep(float step);
+
+		//Returns the fixed step the emitter is simulated with, 0 if it uses the update delta
+		virtual float GetFixedTimestep();
+
 		/************************************
 						Sets
 		*************************************/
@@ -69,10 +159,13 @@ namespace tle
 		//Emitter//
 
 		//Emission type decides what direction the particles are emitted
+		//The direction of the particle velocity is turned, keeping its speed: Line keeps it, Sphere turns it any way,
+		//Cone within the emission angle of it, Circle to a ring at right angles to it and Arch to a fan within the angle
+		//turning towards the emitter's x axis. The particle's acceleration turns with it
 		virtual void SetEmissionType(EEmissionType type);
 
-		//Set the variance in the direction the particles are emitted
-		//Only affects non circular/linear emissions.
+		//Set the variance in degrees in the direction the particles are emitted
+		//Only affects cone and arch emissions
 		virtual void SetEmissionAngle(float angle);
 
 		//Set the amount of time in seconds between particles being emitted
@@ -103,6 +196,52 @@ namespace tle
 		//Does not retroactively change scale of existing particles
 		virtual void SetParticleScale(float scale);
 
+		//Gives every particle its own quad for each frame of an animated skin
+		//Changing frame then only moves quads instead of swapping them through the model cache
+		virtual void SetParticleFlipbook(bool flipbook);
+
+		//Set how the particle scale changes over the particle's life
+		//The keys are multipliers of the particle scale spread evenly from birth to death
+		virtual void SetParticleScaleCurve(const std::vector<float>& keys);
+
+		//Set how much the particles are slowed down over their life
+		//The keys are the fraction of velocity lost per second spread evenly from birth to death
+		virtual void SetParticleDragCurve(const std::vector<float>& keys);
+
+		/////////////
+		//Collision//
+
+		//Adds a plane, given by a point on it and the normal of the side particles stay on, that particles can't pass through
+		//Bouncing particles keep the bounciness fraction of their speed into the plane
+		//Returns false if the emitter already has the most planes it can hold
+		virtual bool AddCollisionPlane(const CVector3& point, const CVector3& normal,
+								ECollisionResponse response = Bounce, float bounciness = 0.5f);
+
+		//Adds a solid sphere that particles can't pass into
+		//Bouncing particles keep the bounciness fraction of their speed into the sphere
+		//Returns false if the emitter already has the most spheres it can hold
+		virtual bool AddCollisionSphere(const CVector3& centre, float radius,
+								ECollisionResponse response = Bounce, float bounciness = 0.5f);
+
+		//Removes all collision planes and spheres
+		virtual void ClearCollision();
+
+		//////////////
+		//Attachment//
+
+		//Attaches the emitter to the scene node so it follows the node without being moved every frame
+		//The offset is relative to the node and turns with it, the node's matrix is read once each update
+		//The emitter is detached when it is removed
+		virtual void AttachTo(ISceneNode* parent, const CVector3& offset = CVector3(0.0f, 0.0f, 0.0f));
+
+		//Detaches the emitter from the scene node it was attached to
+		virtual void Detach();
+
+		//Do not call
+		//Detaches the emitter when it is removed without reading the node, which may have been removed first
+		//The emitter stays where it was at the last update
+		void ReleaseParent();
+
 		/************************************
 						Gets
 		*************************************/
@@ -143,6 +282,49 @@ namespace tle
 		//Returns the scale of the particle quad model
 		virtual float GetParticleScale();
 
+		//Returns true if every particle has its own quad for each frame
+		virtual bool GetParticleFlipbook();
+
+		//Returns the keys of the scale curve, empty if there is none
+		virtual std::vector<float> GetParticleScaleCurve();
+
+		//Returns the keys of the drag curve, empty if there is none
+		virtual std::vector<float> GetParticleDragCurve();
+
+		/************************************
+					Templates
+		*************************************/
+
+		//Replaces the emitter and particle settings with those of the template
+		//Any active particles are reset
+		void ApplyTemplate(CEmitterTemplate* emitterTemplate);
+
+		//Returns the template the emitter was spawned from, or null
+		CEmitterTemplate* GetTemplate();
+
+		//Forgets the template, called when the template is removed
+		void ClearTemplate();
+
+		//Prepares the emitter to sit idle in its template's pool
+		//Dead particles hand their models back to the engine as idle emitters aren't orientated
+		void Park();
+
+		/************************************
+					Diagnostics
+		*************************************/
+
+		//Returns the first particle currently alive, use CParticle::GetNext to iterate
+		CParticle* GetFirstActiveParticle();
+
+		//Returns the number of particles currently alive
+		int GetActiveParticleCount();
+
+		//Returns the number of dead particles waiting to be reused
+		int GetInactiveParticleCount();
+
+		//Returns an estimate of the memory held by the emitter and its particles in bytes
+		size_t GetMemoryUsage();
+
 		/************************************
 				 Goodbye Cruel World
 		*************************************/
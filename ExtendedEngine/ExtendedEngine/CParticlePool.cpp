@@ -0,0 +1,176 @@
+#include "stdafx.h"
+#include "CParticlePool.h"
+
+namespace tle
+{
+	CParticlePool::CParticlePool(ParticleData* data, ExEngine* engine)
+	{
+		mpActiveHead = 0;
+		mpActiveTail = 0;
+		mActiveCount = 0;
+
+		mpFreeHead = 0;
+		mFreeCount = 0;
+
+		mpData = data;
+		mpEngine = engine;
+	}
+
+	//Allocates a new block of particles and adds them to the free list
+	void CParticlePool::Grow()
+	{
+		CParticle* block = new CParticle[kBlockSize];
+		mBlocks.push_back(std::unique_ptr<CParticle[]>(block));
+
+		//Link them in reverse so that the first particle in the block is handed out first
+		for (int i = kBlockSize - 1; i >= 0; --i)
+		{
+			block[i].Init(mpData, mpEngine);
+			block[i].mpNext = mpFreeHead;
+			block[i].mpPrev = 0;
+			mpFreeHead = &block[i];
+		}
+		mFreeCount += kBlockSize;
+	}
+
+	//Takes a particle from the free list and adds it to the end of the active list
+	//A new block is allocated if the free list is empty
+	CParticle* CParticlePool::Spawn()
+	{
+		if (!mpFreeHead) Grow();
+
+		//Pop from the free list
+		CParticle* particle = mpFreeHead;
+		mpFreeHead = particle->mpNext;
+		--mFreeCount;
+
+		//Push onto the end of the active list
+		particle->mpNext = 0;
+		particle->mpPrev = mpActiveTail;
+		if (mpActiveTail) mpActiveTail->mpNext = particle;
+		else mpActiveHead = particle;
+		mpActiveTail = particle;
+		++mActiveCount;
+
+		return particle;
+	}
+
+	//Moves an active particle onto the free list
+	void CParticlePool::Kill(CParticle* particle)
+	{
+		//Unlink from the active list
+		if (particle->mpPrev) particle->mpPrev->mpNext = particle->mpNext;
+		else mpActiveHead = particle->mpNext;
+		if (particle->mpNext) particle->mpNext->mpPrev = particle->mpPrev;
+		else mpActiveTail = particle->mpPrev;
+		--mActiveCount;
+
+		//Push onto the front of the free list
+		particle->mpNext = mpFreeHead;
+		particle->mpPrev = 0;
+		mpFreeHead = particle;
+		++mFreeCount;
+	}
+
+	//Moves every active particle onto the free list at once
+	//The particles keep their models, which are hidden with the rest of the free particles
+	void CParticlePool::KillAll()
+	{
+		if (!mpActiveHead) return;
+
+		//Splice the whole active list onto the front of the free list
+		//The back links of the spliced particles are left as they are, the free list never reads them
+		mpActiveTail->mpNext = mpFreeHead;
+		mpFreeHead = mpActiveHead;
+		mFreeCount += mActiveCount;
+
+		mpActiveHead = 0;
+		mpActiveTail = 0;
+		mActiveCount = 0;
+	}
+
+	//Allocates blocks until the pool can hold the amount of particles
+	//Every free particle is given a model so the first spawns don't have to wait on the engine
+	void CParticlePool::Reserve(int amount)
+	{
+		while (GetCapacity() < amount)
+		{
+			Grow();
+		}
+
+		for (CParticle* particle = mpFreeHead; particle; particle = particle->mpNext)
+		{
+			particle->PrepareModel();
+		}
+	}
+
+	//Returns all the models of the free particles back to the engine
+	void CParticlePool::ReleaseFreeModels()
+	{
+		for (CParticle* particle = mpFreeHead; particle; particle = particle->mpNext)
+		{
+			particle->ReleaseModel();
+		}
+	}
+
+	//Points every particle, including those not yet spawned, at new particle data
+	void CParticlePool::SetData(ParticleData* data)
+	{
+		mpData = data;
+		for (auto block = mBlocks.begin(); block != mBlocks.end(); ++block)
+		{
+			for (int i = 0; i < kBlockSize; ++i)
+			{
+				(*block)[i].Init(mpData, mpEngine);
+			}
+		}
+	}
+
+	//Destroys every particle, returning all models back to the engine
+	void CParticlePool::Clear()
+	{
+		mBlocks.clear();
+
+		mpActiveHead = 0;
+		mpActiveTail = 0;
+		mActiveCount = 0;
+
+		mpFreeHead = 0;
+		mFreeCount = 0;
+	}
+
+	//Returns the first active particle, use CParticle::GetNext to iterate
+	CParticle* CParticlePool::GetFirstActive()
+	{
+		return mpActiveHead;
+	}
+
+	//Returns the first free particle, use CParticle::GetNext to iterate
+	CParticle* CParticlePool::GetFirstFree()
+	{
+		return mpFreeHead;
+	}
+
+	//Returns the number of active particles
+	int CParticlePool::GetActiveCount()
+	{
+		return mActiveCount;
+	}
+
+	//Returns the number of free particles
+	int CParticlePool::GetFreeCount()
+	{
+		return mFreeCount;
+	}
+
+	//Returns the number of particles the pool has allocated
+	int CParticlePool::GetCapacity()
+	{
+		return static_cast<int>(mBlocks.size()) * kBlockSize;
+	}
+
+	CParticlePool::~CParticlePool()
+	{
+		Clear();
+	}
+}
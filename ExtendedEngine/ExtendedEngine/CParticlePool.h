@@ -0,0 +1,81 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include "CParticle.h"
+
+namespace tle
+{
+	//Hacky work around to avoid circular reference
+	class ExEngine;
+
+	//Owns all of a single emitter's particles
+	//Particles are allocated in fixed size blocks and never freed individually, instead dead particles
+	//are kept on an intrusive free list and handed back out. Once warmed up an emitter never touches the heap
+	class CParticlePool
+	{
+	private:
+		//Number of particles allocated at a time when the free list runs dry
+		static const int kBlockSize = 64;
+
+		vector_ptr<CParticle[]> mBlocks;
+
+		//Active particles are doubly linked so they can be killed from anywhere in the list
+		CParticle* mpActiveHead;
+		CParticle* mpActiveTail;
+		int mActiveCount;
+
+		//Free particles are singly linked, most recently killed first
+		CParticle* mpFreeHead;
+		int mFreeCount;
+
+		ParticleData* mpData;
+		ExEngine* mpEngine;
+
+		//Allocates a new block of particles and adds them to the free list
+		void Grow();
+
+	public:
+		CParticlePool(ParticleData* data, ExEngine* engine);
+
+		//Takes a particle from the free list and adds it to the end of the active list
+		//A new block is allocated if the free list is empty
+		CParticle* Spawn();
+
+		//Moves an active particle onto the free list
+		void Kill(CParticle* particle);
+
+		//Moves every active particle onto the free list at once
+		//The particles keep their models, which are hidden with the rest of the free particles
+		void KillAll();
+
+		//Allocates blocks until the pool can hold the amount of particles
+		//Every free particle is given a model so the first spawns don't have to wait on the engine
+		void Reserve(int amount);
+
+		//Returns all the models of the free particles back to the engine
+		void ReleaseFreeModels();
+
+		//Points every particle, including those not yet spawned, at new particle data
+		void SetData(ParticleData* data);
+
+		//Destroys every particle, returning all models back to the engine
+		void Clear();
+
+		//Returns the first active particle, use CParticle::GetNext to iterate
+		CParticle* GetFirstActive();
+
+		//Returns the first free particle, use CParticle::GetNext to iterate
+		CParticle* GetFirstFree();
+
+		//Returns the number of active particles
+		int GetActiveCount();
+
+		//Returns the number of free particles
+		int GetFreeCount();
+
+		//Returns the number of particles the pool has allocated
+		int GetCapacity();
+
+		~CParticlePool();
+	};
+}
@@ -0,0 +1,175 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include "IHandle.h"
+
+namespace tle
+{
+	//Owns objects in a dense array for fast iteration while handing out generational handles to them
+	//Lookup and removal by handle or by pointer are O(1), removal swaps the last object into the gap
+	//so the order of iteration is not kept
+	//T is the stored type and I the interface handles are typed by
+	template<class T, class I = T>
+	class CSlotMap
+	{
+	public:
+		using Handle = SHandle<I>;
+		using iterator = typename std::vector<std::unique_ptr<T>>::iterator;
+
+	private:
+		//Slots never move so handles stay valid while objects are moved around the dense array
+		//Free slots are linked through mNextFree
+		struct SSlot
+		{
+			int mDense;
+			unsigned int mGeneration;
+			int mNextFree;
+		};
+
+		std::vector<std::unique_ptr<T>> mDense;
+		std::vector<int> mDenseSlots; //Slot of each object in the dense array
+		std::vector<SSlot> mSlots;
+		int mFreeSlot;
+
+		//Lets objects still be found from the pointers given out to the user
+		std::unordered_map<const I*, int> mPointerSlots;
+
+		//Bumps the generation of the slot, making any handles to it stale, and adds it to the free list
+		void FreeSlot(int slot)
+		{
+			++mSlots[slot].mGeneration;
+			mSlots[slot].mDense = -1;
+			mSlots[slot].mNextFree = mFreeSlot;
+			mFreeSlot = slot;
+		}
+
+	public:
+		CSlotMap()
+		{
+			mFreeSlot = -1;
+		}
+
+		//Takes ownership of the object and returns a handle to it
+		Handle Insert(std::unique_ptr<T>&& object)
+		{
+			int slot = mFreeSlot;
+			if (slot >= 0)
+			{
+				mFreeSlot = mSlots[slot].mNextFree;
+			}
+			else
+			{
+				slot = static_cast<int>(mSlots.size());
+				mSlots.push_back(SSlot{ -1, 1, -1 });
+			}
+
+			mSlots[slot].mDense = static_cast<int>(mDense.size());
+			mPointerSlots[object.get()] = slot;
+			mDense.push_back(std::move(object));
+			mDenseSlots.push_back(slot);
+
+			return Handle(slot, mSlots[slot].mGeneration);
+		}
+
+		//Returns the object of the handle, or null if the handle is stale
+		T* Get(Handle handle)
+		{
+			if (!Contains(handle)) return 0;
+			return mDense[mSlots[handle.mIndex].mDense].get();
+		}
+
+		//Returns true if the handle's object is still in the map
+		bool Contains(Handle handle)
+		{
+			return handle.mIndex >= 0 && handle.mIndex < static_cast<int>(mSlots.size()) &&
+				mSlots[handle.mIndex].mGeneration == handle.mGeneration && mSlots[handle.mIndex].mDense >= 0;
+		}
+
+		//Returns a handle to the object, or a null handle if the object is not in the map
+		//Pointers carry no generation, a stale pointer whose address has been reused finds the new object
+		Handle Find(const I* object)
+		{
+			auto it = mPointerSlots.find(object);
+			if (it == mPointerSlots.end()) return Handle();
+			return Handle(it->second, mSlots[it->second].mGeneration);
+		}
+
+		//Removes the object from the map and gives it back to the caller
+		//Returns null if the handle is stale
+		std::unique_ptr<T> Take(Handle handle)
+		{
+			if (!Contains(handle)) return std::unique_ptr<T>();
+
+			//Swap the last object into the gap
+			const int dense = mSlots[handle.mIndex].mDense;
+			const int last = static_cast<int>(mDense.size()) - 1;
+			std::unique_ptr<T> object = std::move(mDense[dense]);
+			if (dense != last)
+			{
+				mDense[dense] = std::move(mDense[last]);
+				mDenseSlots[dense] = mDenseSlots[last];
+				mSlots[mDenseSlots[dense]].mDense = dense;
+			}
+			mDense.pop_back();
+			mDenseSlots.pop_back();
+
+			mPointerSlots.erase(object.get());
+			FreeSlot(handle.mIndex);
+
+			return object;
+		}
+
+		//Removes the object from the map and gives it back to the caller
+		//Returns null if the object is not in the map
+		std::unique_ptr<T> Take(const I* object)
+		{
+			return Take(Find(object));
+		}
+
+		//Destroys every object, all handles given out become stale
+		void Clear()
+		{
+			for (auto slot = mDenseSlots.begin(); slot != mDenseSlots.end(); ++slot)
+			{
+				FreeSlot(*slot);
+			}
+			mDenseSlots.clear();
+			mPointerSlots.clear();
+
+			//Objects are destroyed after the map is emptied in case their destructors look at it
+			std::vector<std::unique_ptr<T>> objects;
+			objects.swap(mDense);
+		}
+
+		//Returns the number of objects in the map
+		int Size()
+		{
+			return static_cast<int>(mDense.size());
+		}
+
+		//Returns true if there are no objects in the map
+		bool Empty()
+		{
+			return mDense.empty();
+		}
+
+		//Returns an estimate of the memory used by the map itself in bytes, not including the objects
+		size_t GetMemoryUsage()
+		{
+			return mDense.capacity() * sizeof(std::unique_ptr<T>) + mDenseSlots.capacity() * sizeof(int) +
+				mSlots.capacity() * sizeof(SSlot) + mPointerSlots.size() * (sizeof(const I*) + sizeof(int) + 2 * sizeof(void*));
+		}
+
+		//Iterates over the objects in the dense array
+		iterator begin()
+		{
+			return mDense.begin();
+		}
+
+		iterator end()
+		{
+			return mDense.end();
+		}
+	};
+}
\ No newline at end of file
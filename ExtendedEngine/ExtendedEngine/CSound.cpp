@@ -11,6 +11,7 @@ namespace tle
 		mVolume = 100.0f;
 		mpSound = new sf::Sound(*buffer);
 		mpManager = manager;
+		mWatchSlot = -1;
 
 		mpSound->setVolume(mpManager->GetVolume(mType));
 	}
@@ -41,6 +42,7 @@ namespace tle
 	void CSound::Play()
 	{
 		mpSound->play();
+		mpManager->WatchSound(this);
 	}
 
 	//Pause the music, Play() will resume
@@ -88,6 +90,7 @@ namespace tle
 	//Destroys the sound
 	CSound::~CSound()
 	{
+		mpManager->UnwatchSound(this);
 		delete mpSound;
 	}
 }
\ No newline at end of file
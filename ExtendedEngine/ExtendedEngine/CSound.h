@@ -1,5 +1,5 @@
 #pragma once
-#include <SFML\Audio\Sound.hpp>
+#include <SFML/Audio/Sound.hpp>
 #include "ISound.h"
 
 namespace tle
@@ -15,6 +15,9 @@ namespace tle
 		sf::Sound* mpSound;			//The internal sound object
 
 		float mVolume;				//The individual volume control
+		int mWatchSlot;				//Slot in the manager's list of played sounds to check for stopping, -1 if not in it
+
+		friend class CSoundManager;
 
 	public:
 		//Creates a sound object
@@ -51,7 +51,7 @@ namespace tle
 		
 		CSound* sound = new CSound(SoundType::SFX, buffer, this);
 
-		mSounds.push_back(CSound_ptr(sound));
+		mSounds.Insert(CSound_ptr(sound));
 
 		return sound;
 	}
@@ -59,20 +59,32 @@ namespace tle
 	//Removes the sound
 	void CSoundManager::RemoveSound(ISound* pSound)
 	{
-		for (auto it = mSounds.begin(); it != mSounds.end(); ++it)
-		{
-			if ((*it).get() == pSound)
-			{
-				mSounds.erase(it);
-				return; //No point going through the rest of the list
-			}
-		}
+		RemoveSound(mSounds.Find(pSound));
+	}
+
+	//Removes the sound if the handle isn't stale
+	void CSoundManager::RemoveSound(SHandle<ISound> handle)
+	{
+		//The sound is destroyed as it goes out of scope
+		mSounds.Take(handle);
+	}
+
+	//Returns a handle to the sound, or a null handle if it doesn't exist
+	SHandle<ISound> CSoundManager::GetSoundHandle(ISound* pSound)
+	{
+		return mSounds.Find(pSound);
+	}
+
+	//Returns the sound of the handle, or 0 if it has been removed
+	ISound* CSoundManager::GetSound(SHandle<ISound> handle)
+	{
+		return mSounds.Get(handle);
 	}
 
 	//Removes all sounds
 	void CSoundManager::ClearSounds()
 	{
-		mSounds.clear();
+		mSounds.Clear();
 		mSoundBuffers.clear();
 	}
 
@@ -88,7 +100,7 @@ namespace tle
 		if (sfmusic->openFromFile(musicFile))
 		{
 			CMusic* music = new CMusic(SoundType::Music, sfmusic, this);
-			mMusics.push_back(CMusic_ptr(music));
+			mMusics.Insert(CMusic_ptr(music));
 			return music;
 		}
 		else
@@ -101,20 +113,32 @@ namespace tle
 	//Removes the music
 	void CSoundManager::RemoveMusic(IMusic* pMusic)
 	{
-		for (auto it = mMusics.begin(); it != mMusics.end(); ++it)
-		{
-			if ((*it).get() == pMusic)
-			{
-				mMusics.erase(it);
-				return; //No point going through the rest of the list
-			}
-		}
+		RemoveMusic(mMusics.Find(pMusic));
+	}
+
+	//Removes the music if the handle isn't stale
+	void CSoundManager::RemoveMusic(SHandle<IMusic> handle)
+	{
+		//The music is destroyed as it goes out of scope
+		mMusics.Take(handle);
+	}
+
+	//Returns a handle to the music, or a null handle if it doesn't exist
+	SHandle<IMusic> CSoundManager::GetMusicHandle(IMusic* pMusic)
+	{
+		return mMusics.Find(pMusic);
+	}
+
+	//Returns the music of the handle, or 0 if it has been removed
+	IMusic* CSoundManager::GetMusic(SHandle<IMusic> handle)
+	{
+		return mMusics.Get(handle);
 	}
 
 	//Removes all music
 	void CSoundManager::ClearMusic()
 	{
-		mMusics.clear();
+		mMusics.Clear();
 	}
 
 	/*******************
@@ -181,6 +205,141 @@ namespace tle
 		}
 	}
 
+	/*******************
+			Events
+	********************/
+
+	//Starts checking the sound for stopping, called when the sound is played
+	void CSoundManager::WatchSound(CSound* pSound)
+	{
+		if (pSound->mWatchSlot >= 0) return;
+
+		pSound->mWatchSlot = static_cast<int>(mPlayingSounds.size());
+		mPlayingSounds.push_back(pSound);
+	}
+
+	//Stops checking the sound for stopping
+	void CSoundManager::UnwatchSound(CSound* pSound)
+	{
+		if (pSound->mWatchSlot < 0) return;
+
+		//Swap the last sound into the gap, order doesn't matter
+		CSound* last = mPlayingSounds.back();
+		mPlayingSounds[pSound->mWatchSlot] = last;
+		last->mWatchSlot = pSound->mWatchSlot;
+		mPlayingSounds.pop_back();
+		pSound->mWatchSlot = -1;
+	}
+
+	//Starts checking the music for stopping, called when the music is played
+	void CSoundManager::WatchMusic(CMusic* pMusic)
+	{
+		if (pMusic->mWatchSlot >= 0) return;
+
+		pMusic->mWatchSlot = static_cast<int>(mPlayingMusic.size());
+		mPlayingMusic.push_back(pMusic);
+	}
+
+	//Stops checking the music for stopping
+	void CSoundManager::UnwatchMusic(CMusic* pMusic)
+	{
+		if (pMusic->mWatchSlot < 0) return;
+
+		//Swap the last music into the gap, order doesn't matter
+		CMusic* last = mPlayingMusic.back();
+		mPlayingMusic[pMusic->mWatchSlot] = last;
+		last->mWatchSlot = pMusic->mWatchSlot;
+		mPlayingMusic.pop_back();
+		pMusic->mWatchSlot = -1;
+	}
+
+	//Queues an event for every played sound and music that has stopped since the last call
+	//Paused sounds and music are kept until they are played again or stopped
+	void CSoundManager::QueueEvents(std::deque<SEngineEvent>& events)
+	{
+		for (size_t i = 0; i < mPlayingSounds.size(); /*Only increment if no removal occurs*/)
+		{
+			CSound* sound = mPlayingSounds[i];
+			if (sound->GetStatus() != sf::SoundSource::Stopped)
+			{
+				++i;
+				continue;
+			}
+
+			SEngineEvent event;
+			event.mType = SoundStopped;
+			event.mSound = mSounds.Find(sound);
+			events.push_back(event);
+
+			UnwatchSound(sound);
+		}
+
+		for (size_t i = 0; i < mPlayingMusic.size(); /*Only increment if no removal occurs*/)
+		{
+			CMusic* music = mPlayingMusic[i];
+			if (music->GetStatus() != sf::SoundSource::Stopped)
+			{
+				++i;
+				continue;
+			}
+
+			SEngineEvent event;
+			event.mType = MusicFinished;
+			event.mMusic = mMusics.Find(music);
+			events.push_back(event);
+
+			UnwatchMusic(music);
+		}
+	}
+
+	/*******************
+		Diagnostics
+	********************/
+
+	//Returns the number of loaded sound buffers
+	int CSoundManager::GetSoundBufferCount()
+	{
+		return static_cast<int>(mSoundBuffers.size());
+	}
+
+	//Returns the number of sound objects
+	int CSoundManager::GetSoundCount()
+	{
+		return mSounds.Size();
+	}
+
+	//Returns the number of music objects
+	int CSoundManager::GetMusicCount()
+	{
+		return mMusics.Size();
+	}
+
+	//Returns an estimate of the sample data held by the sound buffers in bytes
+	size_t CSoundManager::GetSoundBufferBytes()
+	{
+		size_t bytes = 0;
+		for (auto& buffer : mSoundBuffers)
+		{
+			bytes += sizeof(sf::SoundBuffer) + buffer.first.capacity();
+			bytes += static_cast<size_t>(buffer.second->getSampleCount()) * sizeof(sf::Int16);
+		}
+		bytes += static_cast<size_t>(mSounds.Size()) * (sizeof(CSound) + sizeof(sf::Sound));
+		return bytes;
+	}
+
+	//Returns an estimate of the memory held by the music streams in bytes
+	//sf::Music only keeps around a second of decoded samples in memory at a time
+	size_t CSoundManager::GetMusicBytes()
+	{
+		size_t bytes = 0;
+		for (auto& music : mMusics)
+		{
+			bytes += sizeof(CMusic) + sizeof(sf::Music);
+			bytes += static_cast<size_t>(music->GetSampleRate()) * music->GetChannelCount() * sizeof(sf::Int16);
+		}
+		return bytes;
+	}
+
 	/*******************
 		Destruction
 	********************/
@@ -1,9 +1,12 @@
 #pragma once
-#include <SFML\Audio.hpp>
+#include <SFML/Audio.hpp>
 #include <unordered_map>
 #include <memory>
+#include <deque>
 #include "CSound.h"
 #include "CMusic.h"
+#include "CSlotMap.h"
+#include "IEngineEvent.h"
 
 namespace tle
 {
@@ -16,10 +19,16 @@ namespace tle
 		using SoundBuffer_ptr = std::unique_ptr<sf::SoundBuffer>;
 		using TBufferPair = std::pair<std::string, std::unique_ptr<sf::SoundBuffer>>;
 		using TSoundMap = std::unordered_map<std::string, std::unique_ptr<sf::SoundBuffer>>; //Thank stroustrup for typedefs
-		using TSoundList = std::list<CSound_ptr>;
-		using TMusicList = std::list<CMusic_ptr>;
+		using TSoundList = CSlotMap<CSound, ISound>;
+		using TMusicList = CSlotMap<CMusic, IMusic>;
 
 		TSoundMap mSoundBuffers;
+
+		//Sounds and music that have been played, checked every frame for stopping instead of checking them all
+		//Unordered, removed by swapping with the last, must outlive the sounds and music
+		std::vector<CSound*> mPlayingSounds;
+		std::vector<CMusic*> mPlayingMusic;
+
 		TSoundList mSounds;
 		TMusicList mMusics;
 
@@ -47,6 +56,15 @@ namespace tle
 		//Removes the sound
 		void RemoveSound(ISound* pSound);
 
+		//Removes the sound if the handle isn't stale
+		void RemoveSound(SHandle<ISound> handle);
+
+		//Returns a handle to the sound, or a null handle if it doesn't exist
+		SHandle<ISound> GetSoundHandle(ISound* pSound);
+
+		//Returns the sound of the handle, or 0 if it has been removed
+		ISound* GetSound(SHandle<ISound> handle);
+
 		//Removes all sounds
 		void ClearSounds();
 
@@ -61,6 +79,15 @@ namespace tle
 		//Removes the music
 		void RemoveMusic(IMusic* pMusic);
 
+		//Removes the music if the handle isn't stale
+		void RemoveMusic(SHandle<IMusic> handle);
+
+		//Returns a handle to the music, or a null handle if it doesn't exist
+		SHandle<IMusic> GetMusicHandle(IMusic* pMusic);
+
+		//Returns the music of the handle, or 0 if it has been removed
+		IMusic* GetMusic(SHandle<IMusic> handle);
+
 		//Removes all music
 		void ClearMusic();
 
@@ -74,6 +101,45 @@ namespace tle
 		//Gets the volume for the specific volume modifier
 		float GetVolume(SoundType type);
 
+		/*******************
+				Events
+		********************/
+
+		//Starts checking the sound for stopping, called when the sound is played
+		void WatchSound(CSound* pSound);
+
+		//Stops checking the sound for stopping
+		void UnwatchSound(CSound* pSound);
+
+		//Starts checking the music for stopping, called when the music is played
+		void WatchMusic(CMusic* pMusic);
+
+		//Stops checking the music for stopping
+		void UnwatchMusic(CMusic* pMusic);
+
+		//Queues an event for every played sound and music that has stopped since the last call
+		//Paused sounds and music are kept until they are played again or stopped
+		void QueueEvents(std::deque<SEngineEvent>& events);
+
+		/*******************
+			Diagnostics
+		********************/
+
+		//Returns the number of loaded sound buffers
+		int GetSoundBufferCount();
+
+		//Returns the number of sound objects
+		int GetSoundCount();
+
+		//Returns the number of music objects
+		int GetMusicCount();
+
+		//Returns an estimate of the sample data held by the sound buffers in bytes
+		size_t GetSoundBufferBytes();
+
+		//Returns an estimate of the memory held by the music streams in bytes
+		size_t GetMusicBytes();
+
 		/*******************
 			Destruction
 		********************/
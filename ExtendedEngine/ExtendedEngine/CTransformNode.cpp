@@ -0,0 +1,490 @@
+#include "stdafx.h"
+#include "CTransformNode.h"
+#include <cmath>
+
+namespace tle
+{
+	//Multiplies two affine matrices, positions are transformed by a then b
+	static void MultiplyMatrix(const float* a, const float* b, float* result)
+	{
+		for (int row = 0; row < 4; ++row)
+		{
+			for (int column = 0; column < 3; ++column)
+			{
+				result[row * 4 + column] = a[row * 4] * b[column] + a[row * 4 + 1] * b[4 + column] + a[row * 4 + 2] * b[8 + column];
+			}
+			result[row * 4 + 3] = row == 3 ? 1.0f : 0.0f;
+		}
+		result[12] += b[12];
+		result[13] += b[13];
+		result[14] += b[14];
+	}
+
+	//Writes the inverse of the rotation and scale part of an affine matrix into the rows 0-2 of the result
+	//Returns false if the matrix has no inverse
+	static bool InvertAxes(const float* m, float* result)
+	{
+		float det = m[0] * (m[5] * m[10] - m[6] * m[9]) - m[1] * (m[4] * m[10] - m[6] * m[8]) + m[2] * (m[4] * m[9] - m[5] * m[8]);
+		if (det == 0.0f) return false;
+
+		float inv = 1.0f / det;
+		result[0] = (m[5] * m[10] - m[6] * m[9]) * inv;
+		result[1] = (m[2] * m[9] - m[1] * m[10]) * inv;
+		result[2] = (m[1] * m[6] - m[2] * m[5]) * inv;
+		result[4] = (m[6] * m[8] - m[4] * m[10]) * inv;
+		result[5] = (m[0] * m[10] - m[2] * m[8]) * inv;
+		result[6] = (m[2] * m[4] - m[0] * m[6]) * inv;
+		result[8] = (m[4] * m[9] - m[5] * m[8]) * inv;
+		result[9] = (m[1] * m[8] - m[0] * m[9]) * inv;
+		result[10] = (m[0] * m[5] - m[1] * m[4]) * inv;
+		return true;
+	}
+
+	//Returns the length of the row of the matrix
+	static float RowLength(const float* m, int row)
+	{
+		return sqrtf(m[row * 4] * m[row * 4] + m[row * 4 + 1] * m[row * 4 + 1] + m[row * 4 + 2] * m[row * 4 + 2]);
+	}
+
+	//Scales the row of the matrix to the length, rows of no length are left alone
+	static void SetRowLength(float* m, int row, float length)
+	{
+		float current = RowLength(m, row);
+		if (current == 0.0f) return;
+
+		for (int i = 0; i < 3; ++i)
+		{
+			m[row * 4 + i] *= length / current;
+		}
+	}
+
+	//Creates a node at the origin of the world with no rotation or scale
+	CTransformNode::CTransformNode()
+	{
+		for (int i = 0; i < 16; ++i)
+		{
+			mMatrix[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+		}
+		mpParent = 0;
+	}
+
+	//Rotates the axes about the axis by the angle in degrees
+	//A world rotation turns the axes about an axis of the parent, a local one about an axis of the node
+	void CTransformNode::Rotate(int axis, float degrees, bool local)
+	{
+		const float kPi = 3.14159265f;
+		float s = sinf(degrees * kPi / 180.0f);
+		float c = cosf(degrees * kPi / 180.0f);
+
+		//Rotation for row vectors in the TL-Engine's left handed space
+		float rotation[9] = { 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+		int a = (axis + 1) % 3;
+		int b = (axis + 2) % 3;
+		rotation[a * 3 + a] = c;
+		rotation[a * 3 + b] = s;
+		rotation[b * 3 + a] = -s;
+		rotation[b * 3 + b] = c;
+
+		float axes[9];
+		for (int row = 0; row < 3; ++row)
+		{
+			for (int column = 0; column < 3; ++column)
+			{
+				if (local) //Mix the rows, each axis is turned about the node's own axis
+				{
+					axes[row * 3 + column] = rotation[row * 3] * mMatrix[column] + rotation[row * 3 + 1] * mMatrix[4 + column] +
+						rotation[row * 3 + 2] * mMatrix[8 + column];
+				}
+				else //Turn each axis as a vector of the parent's space
+				{
+					axes[row * 3 + column] = mMatrix[row * 4] * rotation[column] + mMatrix[row * 4 + 1] * rotation[3 + column] +
+						mMatrix[row * 4 + 2] * rotation[6 + column];
+				}
+			}
+		}
+
+		for (int row = 0; row < 3; ++row)
+		{
+			for (int column = 0; column < 3; ++column)
+			{
+				mMatrix[row * 4 + column] = axes[row * 3 + column];
+			}
+		}
+	}
+
+	//Writes the matrix turning positions of the parent's space into world space, the identity if there is no parent
+	void CTransformNode::GetParentMatrix(float* matrix)
+	{
+		if (mpParent)
+		{
+			mpParent->GetMatrix(matrix);
+			return;
+		}
+
+		for (int i = 0; i < 16; ++i)
+		{
+			matrix[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+		}
+	}
+
+	/********************************
+				Position
+	*********************************/
+
+	//World position
+	float CTransformNode::GetX()
+	{
+		if (!mpParent) return mMatrix[12];
+
+		float matrix[16];
+		GetMatrix(matrix);
+		return matrix[12];
+	}
+
+	float CTransformNode::GetY()
+	{
+		if (!mpParent) return mMatrix[13];
+
+		float matrix[16];
+		GetMatrix(matrix);
+		return matrix[13];
+	}
+
+	float CTransformNode::GetZ()
+	{
+		if (!mpParent) return mMatrix[14];
+
+		float matrix[16];
+		GetMatrix(matrix);
+		return matrix[14];
+	}
+
+	//Position relative to the parent
+	float CTransformNode::GetLocalX()
+	{
+		return mMatrix[12];
+	}
+
+	float CTransformNode::GetLocalY()
+	{
+		return mMatrix[13];
+	}
+
+	float CTransformNode::GetLocalZ()
+	{
+		return mMatrix[14];
+	}
+
+	//Sets the position relative to the parent, or the world if there is no parent
+	void CTransformNode::SetX(const float fX)
+	{
+		mMatrix[12] = fX;
+	}
+
+	void CTransformNode::SetY(const float fY)
+	{
+		mMatrix[13] = fY;
+	}
+
+	void CTransformNode::SetZ(const float fZ)
+	{
+		mMatrix[14] = fZ;
+	}
+
+	void CTransformNode::SetPosition(const float fX, const float fY, const float fZ)
+	{
+		mMatrix[12] = fX;
+		mMatrix[13] = fY;
+		mMatrix[14] = fZ;
+	}
+
+	void CTransformNode::SetLocalX(const float fX)
+	{
+		SetX(fX);
+	}
+
+	void CTransformNode::SetLocalY(const float fY)
+	{
+		SetY(fY);
+	}
+
+	void CTransformNode::SetLocalZ(const float fZ)
+	{
+		SetZ(fZ);
+	}
+
+	void CTransformNode::SetLocalPosition(const float fX, const float fY, const float fZ)
+	{
+		SetPosition(fX, fY, fZ);
+	}
+
+	//Moves along the axes of the parent, or the world if there is no parent
+	void CTransformNode::MoveX(const float fX)
+	{
+		mMatrix[12] += fX;
+	}
+
+	void CTransformNode::MoveY(const float fY)
+	{
+		mMatrix[13] += fY;
+	}
+
+	void CTransformNode::MoveZ(const float fZ)
+	{
+		mMatrix[14] += fZ;
+	}
+
+	void CTransformNode::Move(const float fX, const float fY, const float fZ)
+	{
+		mMatrix[12] += fX;
+		mMatrix[13] += fY;
+		mMatrix[14] += fZ;
+	}
+
+	//Moves along the node's own axes
+	void CTransformNode::MoveLocalX(const float fX)
+	{
+		MoveLocal(fX, 0.0f, 0.0f);
+	}
+
+	void CTransformNode::MoveLocalY(const float fY)
+	{
+		MoveLocal(0.0f, fY, 0.0f);
+	}
+
+	void CTransformNode::MoveLocalZ(const float fZ)
+	{
+		MoveLocal(0.0f, 0.0f, fZ);
+	}
+
+	void CTransformNode::MoveLocal(const float fX, const float fY, const float fZ)
+	{
+		//The distances are along the unit axes so the node's scale doesn't change how far it moves
+		const float distance[3] = { fX, fY, fZ };
+		for (int row = 0; row < 3; ++row)
+		{
+			float length = RowLength(mMatrix, row);
+			if (length == 0.0f) continue;
+
+			for (int i = 0; i < 3; ++i)
+			{
+				mMatrix[12 + i] += mMatrix[row * 4 + i] / length * distance[row];
+			}
+		}
+	}
+
+	/********************************
+			   Orientation
+	*********************************/
+
+	//Turns the node's z axis towards the target, keeping its y axis as close to the world's up as it can
+	void CTransformNode::LookAt(ISceneNode* pTarget)
+	{
+		LookAt(pTarget->GetX(), pTarget->GetY(), pTarget->GetZ());
+	}
+
+	void CTransformNode::LookAt(const float fX, const float fY, const float fZ)
+	{
+		float world[16];
+		GetMatrix(world);
+
+		//Work out the world axes facing the target
+		float axes[16] = { 0.0f };
+		axes[8] = fX - world[12];
+		axes[9] = fY - world[13];
+		axes[10] = fZ - world[14];
+		if (RowLength(axes, 2) == 0.0f) return;
+		SetRowLength(axes, 2, 1.0f);
+
+		//Up cross forward, straight up or down falls back to the world's x axis
+		axes[0] = axes[10];
+		axes[2] = -axes[8];
+		if (RowLength(axes, 0) < 0.0001f)
+		{
+			axes[0] = 1.0f;
+			axes[2] = 0.0f;
+		}
+		SetRowLength(axes, 0, 1.0f);
+
+		//Forward cross right
+		axes[4] = axes[9] * axes[2] - axes[10] * axes[1];
+		axes[5] = axes[10] * axes[0] - axes[8] * axes[2];
+		axes[6] = axes[8] * axes[1] - axes[9] * axes[0];
+
+		//Take the axes into the parent's space
+		if (mpParent)
+		{
+			float parent[16];
+			float inverse[16];
+			GetParentMatrix(parent);
+			if (!InvertAxes(parent, inverse)) return;
+
+			float local[16];
+			inverse[12] = inverse[13] = inverse[14] = 0.0f;
+			inverse[3] = inverse[7] = inverse[11] = 0.0f;
+			inverse[15] = 1.0f;
+			MultiplyMatrix(axes, inverse, local);
+			for (int i = 0; i < 12; ++i)
+			{
+				axes[i] = local[i];
+			}
+		}
+
+		//Keep the node's own scale
+		for (int row = 0; row < 3; ++row)
+		{
+			float scale = RowLength(mMatrix, row);
+			SetRowLength(axes, row, 1.0f);
+			for (int i = 0; i < 3; ++i)
+			{
+				mMatrix[row * 4 + i] = axes[row * 4 + i] * scale;
+			}
+		}
+	}
+
+	//Rotates about the axes of the parent, or the world if there is no parent
+	void CTransformNode::RotateX(const float fDegrees)
+	{
+		Rotate(0, fDegrees, false);
+	}
+
+	void CTransformNode::RotateY(const float fDegrees)
+	{
+		Rotate(1, fDegrees, false);
+	}
+
+	void CTransformNode::RotateZ(const float fDegrees)
+	{
+		Rotate(2, fDegrees, false);
+	}
+
+	//Rotates about the node's own axes
+	void CTransformNode::RotateLocalX(const float fDegrees)
+	{
+		Rotate(0, fDegrees, true);
+	}
+
+	void CTransformNode::RotateLocalY(const float fDegrees)
+	{
+		Rotate(1, fDegrees, true);
+	}
+
+	void CTransformNode::RotateLocalZ(const float fDegrees)
+	{
+		Rotate(2, fDegrees, true);
+	}
+
+	//Lines the axes back up with the parent's, keeping the scale
+	void CTransformNode::ResetOrientation()
+	{
+		for (int row = 0; row < 3; ++row)
+		{
+			float scale = RowLength(mMatrix, row);
+			for (int i = 0; i < 3; ++i)
+			{
+				mMatrix[row * 4 + i] = (row == i) ? scale : 0.0f;
+			}
+		}
+	}
+
+	/********************************
+				 Scaling
+	*********************************/
+
+	void CTransformNode::Scale(const float fScale)
+	{
+		ScaleX(fScale);
+		ScaleY(fScale);
+		ScaleZ(fScale);
+	}
+
+	void CTransformNode::ScaleX(const float fScale)
+	{
+		SetRowLength(mMatrix, 0, RowLength(mMatrix, 0) * fScale);
+	}
+
+	void CTransformNode::ScaleY(const float fScale)
+	{
+		SetRowLength(mMatrix, 1, RowLength(mMatrix, 1) * fScale);
+	}
+
+	void CTransformNode::ScaleZ(const float fScale)
+	{
+		SetRowLength(mMatrix, 2, RowLength(mMatrix, 2) * fScale);
+	}
+
+	void CTransformNode::ResetScale()
+	{
+		SetRowLength(mMatrix, 0, 1.0f);
+		SetRowLength(mMatrix, 1, 1.0f);
+		SetRowLength(mMatrix, 2, 1.0f);
+	}
+
+	/********************************
+				 Matrix
+	*********************************/
+
+	//Writes the world matrix, calls into the parent for its matrix if there is one
+	void CTransformNode::GetMatrix(float* pfMatrix)
+	{
+		if (!mpParent)
+		{
+			for (int i = 0; i < 16; ++i)
+			{
+				pfMatrix[i] = mMatrix[i];
+			}
+			return;
+		}
+
+		float parent[16];
+		GetParentMatrix(parent);
+		MultiplyMatrix(mMatrix, parent, pfMatrix);
+	}
+
+	//Sets the matrix relative to the parent, or the world if there is no parent
+	void CTransformNode::SetMatrix(const float* pfMatrix)
+	{
+		for (int i = 0; i < 16; ++i)
+		{
+			mMatrix[i] = pfMatrix[i];
+		}
+	}
+
+	/********************************
+				Parenting
+	*********************************/
+
+	//Makes the node's matrix relative to the parent, the node keeps its matrix so moves with the parent from where it is
+	void CTransformNode::AttachToParent(ISceneNode* pParent)
+	{
+		mpParent = pParent;
+	}
+
+	//Detaches the node from its parent, keeping where it is in the world
+	void CTransformNode::DetachFromParent()
+	{
+		if (!mpParent) return;
+
+		float world[16];
+		GetMatrix(world);
+		SetMatrix(world);
+		mpParent = 0;
+	}
+
+	//Drops the parent without reading its matrix, for when the parent may already have been removed
+	//The matrix is left relative to the old parent, so the caller should set the world matrix to keep
+	void CTransformNode::ClearParent()
+	{
+		mpParent = 0;
+	}
+
+	//Returns the node's parent, or null if it has none
+	ISceneNode* CTransformNode::GetParent()
+	{
+		return mpParent;
+	}
+
+	CTransformNode::~CTransformNode()
+	{
+	}
+}
\ No newline at end of file
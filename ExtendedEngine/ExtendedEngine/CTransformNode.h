@@ -0,0 +1,125 @@
+#pragma once
+#include <SceneNode.h>
+
+namespace tle
+{
+	//A scene node whose transform is kept by the engine instead of the TL-Engine's scene manager
+	//Used for objects that only need a position and orientation, so they add nothing to the scene manager's update
+	//The matrix is relative to the parent, the world matrix is worked out from the parent's matrix when it is asked for
+	//Nodes of the TL-Engine can't be attached to a transform node as the scene manager doesn't know about it
+	class CTransformNode : virtual public ISceneNode
+	{
+	private:
+		//Rows 0-2 are the local axes including their scale and row 3 the position, relative to the parent
+		float mMatrix[16];
+		ISceneNode* mpParent;
+
+		//Rotates the axes about the axis by the angle in degrees
+		//A world rotation turns the axes about an axis of the parent, a local one about an axis of the node
+		void Rotate(int axis, float degrees, bool local);
+
+		//Writes the matrix turning positions of the parent's space into world space, the identity if there is no parent
+		void GetParentMatrix(float* matrix);
+
+	protected:
+		//Drops the parent without reading its matrix, for when the parent may already have been removed
+		//The matrix is left relative to the old parent, so the caller should set the world matrix to keep
+		void ClearParent();
+
+	public:
+		//Creates a node at the origin of the world with no rotation or scale
+		CTransformNode();
+
+		/********************************
+					Position
+		*********************************/
+
+		//World position
+		virtual float GetX();
+		virtual float GetY();
+		virtual float GetZ();
+
+		//Position relative to the parent
+		virtual float GetLocalX();
+		virtual float GetLocalY();
+		virtual float GetLocalZ();
+
+		//Sets the position relative to the parent, or the world if there is no parent
+		virtual void SetX(const float fX);
+		virtual void SetY(const float fY);
+		virtual void SetZ(const float fZ);
+		virtual void SetPosition(const float fX, const float fY, const float fZ);
+		virtual void SetLocalX(const float fX);
+		virtual void SetLocalY(const float fY);
+		virtual void SetLocalZ(const float fZ);
+		virtual void SetLocalPosition(const float fX, const float fY, const float fZ);
+
+		//Moves along the axes of the parent, or the world if there is no parent
+		virtual void MoveX(const float fX);
+		virtual void MoveY(const float fY);
+		virtual void MoveZ(const float fZ);
+		virtual void Move(const float fX, const float fY, const float fZ);
+
+		//Moves along the node's own axes
+		virtual void MoveLocalX(const float fX);
+		virtual void MoveLocalY(const float fY);
+		virtual void MoveLocalZ(const float fZ);
+		virtual void MoveLocal(const float fX, const float fY, const float fZ);
+
+		/********************************
+				   Orientation
+		*********************************/
+
+		//Turns the node's z axis towards the target, keeping its y axis as close to the world's up as it can
+		virtual void LookAt(ISceneNode* pTarget);
+		virtual void LookAt(const float fX, const float fY, const float fZ);
+
+		//Rotates about the axes of the parent, or the world if there is no parent
+		virtual void RotateX(const float fDegrees);
+		virtual void RotateY(const float fDegrees);
+		virtual void RotateZ(const float fDegrees);
+
+		//Rotates about the node's own axes
+		virtual void RotateLocalX(const float fDegrees);
+		virtual void RotateLocalY(const float fDegrees);
+		virtual void RotateLocalZ(const float fDegrees);
+
+		//Lines the axes back up with the parent's, keeping the scale
+		virtual void ResetOrientation();
+
+		/********************************
+					 Scaling
+		*********************************/
+
+		virtual void Scale(const float fScale);
+		virtual void ScaleX(const float fScale);
+		virtual void ScaleY(const float fScale);
+		virtual void ScaleZ(const float fScale);
+		virtual void ResetScale();
+
+		/********************************
+					 Matrix
+		*********************************/
+
+		//Writes the world matrix, calls into the parent for its matrix if there is one
+		virtual void GetMatrix(float* pfMatrix);
+
+		//Sets the matrix relative to the parent, or the world if there is no parent
+		virtual void SetMatrix(const float* pfMatrix);
+
+		/********************************
+					Parenting
+		*********************************/
+
+		//Makes the node's matrix relative to the parent, the node keeps its matrix so moves with the parent from where it is
+		virtual void AttachToParent(ISceneNode* pParent);
+
+		//Detaches the node from its parent, keeping where it is in the world
+		virtual void DetachFromParent();
+
+		//Returns the node's parent, or null if it has none
+		ISceneNode* GetParent();
+
+		virtual ~CTransformNode();
+	};
+}
\ No newline at end of file
@@ -1,6 +1,10 @@
 #include "stdafx.h"
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
 
 #include "ExEngine.h"
 
@@ -17,8 +21,25 @@ namespace tle
 	{
 		mAutoUpdate = true;
 		mpSoundManager = new CSoundManager();
+		mpJobSystem = new CJobSystem();
+		mpFilePrefetcher = new CFilePrefetcher();
 
 		mParticleMesh = 0;
+
+		mAnimationCullMargin = 256.0f;
+		mpAttachCamera = 0;
+		for (int i = 0; i < 16; ++i)
+		{
+			mAttachCameraMatrix[i] = 0.0f;
+		}
+		mAttachCentreX = 0.0f;
+		mAttachCentreY = 0.0f;
+		mAttachScale = 0.0f;
+
+		mSortParticles = false;
+		mNextParticleModelOrder = 0;
+		mSortedParticles = 0;
+		mParticleOverdraw = 0.0f;
 	}
 
 	//Attempts to Loads the specificed mesh
@@ -59,6 +80,13 @@ namespace tle
 					}
 				}
 
+				//The particle models are kept in their own cache
+				if (pMesh == mParticleMesh)
+				{
+					mParticleModels.clear();
+					mParticleMesh = 0;
+				}
+
 				CTLXEngineMod::RemoveMesh(mesh->second);
 				mMeshMap.erase(mesh);
 				return;
@@ -66,6 +94,29 @@ namespace tle
 		}
 	}
 
+	// Add a folder to the list of folders searched for media
+	// The prefetcher keeps its own list as the TL-Engine's can't be read back
+	void ExEngine::AddMediaFolder(const string& sFolder)
+	{
+		CTLXEngineMod::AddMediaFolder(sFolder);
+		mpFilePrefetcher->AddFolder(sFolder);
+	}
+
+	// Remove a folder from the list of folders searched for media, returns
+	// true on success (folder was found and removed)
+	bool ExEngine::RemoveMediaFolder(const string& sFolder)
+	{
+		mpFilePrefetcher->RemoveFolder(sFolder);
+		return CTLXEngineMod::RemoveMediaFolder(sFolder);
+	}
+
+	// Clears the list of folders searched for media
+	void ExEngine::ClearMediaFolders()
+	{
+		CTLXEngineMod::ClearMediaFolders();
+		mpFilePrefetcher->ClearFolders();
+	}
+
 	// Draw everything in the scene from the viewpoint of the given camera.
 	// If no camera is supplied, the most recently created camera is used.
 	void ExEngine::DrawScene(ICamera* pCamera)
@@ -79,6 +130,9 @@ namespace tle
 		//If a camera is still not selected then skip the updating of the particle locations/orientation
 		if (pCamera)
 		{
+			//Put animations where the nodes they are attached to are seen from the camera
+			PlaceAttachedAnimations(pCamera);
+
 			//Make particle emitters's particles face the camera
 			for (auto emitter = mEmitters.begin(); emitter != mEmitters.end(); ++emitter)
 			{
@@ -89,6 +143,8 @@ namespace tle
 				(*emitter)->OrientateParticles(pCamera);
 			}
 
+			if (mSortParticles) SortParticles(pCamera);
+
 			//Hide unused particles
 			float matrix[16];
 
@@ -98,13 +154,13 @@ namespace tle
 				(matrix[1] * -100.0f) + pCamera->GetY(),
 				(matrix[2] * -100.0f) + pCamera->GetZ());
 
-			/*for (auto particleList = mParticleModels.begin(); particleList != mParticleModels.end(); ++particleList)
+			for (auto particleList = mParticleModels.begin(); particleList != mParticleModels.end(); ++particleList)
 			{
-				for (auto particle = particleList->second.begin(); particle != particleList->second.end(); ++particle)
+				for (auto particle = particleList->begin(); particle != particleList->end(); ++particle)
 				{
-					(*particle)->SetPosition(pos.x, pos.y, pos.z);
+					particle->mpModel->SetPosition(pos.x, pos.y, pos.z);
 				}
-			}*/
+			}
 
 			for (auto modelList = mModelCache.begin(); modelList != mModelCache.end(); ++modelList)
 			{
@@ -125,36 +181,13 @@ namespace tle
 	{
 		float frameTime = CTLXEngineMod::Timer();
 
-		if (mAutoUpdate)
-		{
-			//Update animations
-			for (auto animation = mAnimations.begin(); animation != mAnimations.end(); ++animation)
-			{
-				(*animation)->Update(frameTime);
-			}
-
-			//Update emitters
-			for (auto emitter = mEmitters.begin(); emitter != mEmitters.end(); ++emitter)
-			{
-				(*emitter)->Update(frameTime);
-			}
+		if (mAutoUpdate) StepAutoUpdates(frameTime);
 
-			//Update dying emitters
-			for (auto emitter = mDyingEmitters.begin(); emitter != mDyingEmitters.end(); /*Only increment if no erase occurs*/)
-			{
-				(*emitter)->Update(frameTime);
+		//Sounds play on their own so are checked even while auto updates are paused
+		mpSoundManager->QueueEvents(mEvents);
 
-				//Erase if dead
-				if (!(*emitter)->HasActiveParticles())
-				{
-					emitter = mDyingEmitters.erase(emitter);
-				}
-				else
-				{
-					++emitter;
-				}
-			}
-		}
+		//Drop the oldest events if nobody is draining the queue
+		TrimEvents();
 
 		return frameTime;
 	}
@@ -416,71 +449,183 @@ namespace tle
 	//Creates an animation at the given location
 	//Runs through the frames at a tick rate
 	//Return 0 if failed to load any of the animation frames
-	IAnimation* ExEngine::CreateAnimation(const std::vector<string>& frameList, const CVector3& position, const float tickRate, const bool looped)
+	//Animations of the same frame list share a frame set, sprites parked by removed animations are reused
+	IAnimation* ExEngine::CreateAnimation(const std::vector<string>& frameList, const CVector3& position, const float tickRate, const bool looped,
+											const EAnimationMode mode)
 	{
+		CFrameSet* frameSet = GetFrameSet(frameList);
+
 		SpriteVector sprites;
-		for (auto it = frameList.begin(); it != frameList.end(); ++it)
+		std::vector<float> depths;
+		if (mode == Streamed)
 		{
-			ISprite* newSprite = CreateSprite(*it, position.x, position.y, position.z);
-
-			//Couldn't load sprite
-			if (!newSprite)
+			//Only the first frame is loaded up front, the animation loads the rest as it plays
+			//It is loaded here so creation can be aborted if the frames can't be loaded
+			sprites.resize(frameList.size(), 0);
+			depths.resize(frameList.size(), 0.0f);
+			if (!sprites.empty()) sprites[0] = frameSet->TakeSprite(0, depths[0]);
+			if (!sprites.empty() && !sprites[0])
 			{
-				std::cout << "Could not load image file \"" + (*it) + "\" Aborting creation of IAnimation.";
-
-				//Remove sprites
-				for (auto sprite = sprites.begin(); sprite != sprites.end(); ++sprite)
-				{
-					CTLXEngineMod::RemoveSprite(*sprite);
-				}
+				std::cout << " Aborting creation of IAnimation.";
 				return 0;
 			}
 		}
-		CAnimation* animation = new CAnimation(this, sprites, position, tickRate, looped);
-		mAnimations.push_back(unique_ptr<CAnimation>(animation));
+		else if (!frameSet->Load())
+		{
+			std::cout << " Aborting creation of IAnimation.";
+			return 0;
+		}
+		else if (mode == SingleSprite)
+		{
+			//The animation borrows the sprite of the frame it shows from the frame set
+			sprites.resize(frameList.size(), 0);
+		}
+		else
+		{
+			frameSet->TakeSprites(sprites, depths);
+		}
+
+		CAnimation* animation = new CAnimation(this, &mAnimationClock, frameSet, sprites, depths, position, tickRate, looped, mode);
+		mAnimations.Insert(unique_ptr<CAnimation>(animation));
 		return animation;
 	}
 
 	//Creates an animation at the given location
 	//Runs through the frames at a tick rate
 	//Return 0 if failed to load any of the animation frames
-	IAnimation* ExEngine::CreateAnimation(string& name, string& extension, int amount, const CVector3& position, const float tickRate, const bool looped)
+	IAnimation* ExEngine::CreateAnimation(string& name, string& extension, int amount, const CVector3& position, const float tickRate, const bool looped,
+											const EAnimationMode mode)
 	{
-		SpriteVector sprites;
+		std::vector<string> frameList;
 		for (int i = 0; i < amount; ++i)
 		{
-			string spriteFile = name + to_string(i) + extension;
-			ISprite* newSprite = CreateSprite(spriteFile, position.x, position.y, position.z);
-
-			//Couldn't load sprite
-			if (!newSprite)
-			{
-				std::cout << "Could not load image file \"" + spriteFile + "\" Aborting creation of IAnimation.";
+			frameList.push_back(name + to_string(i) + extension);
+		}
+		return CreateAnimation(frameList, position, tickRate, looped, mode);
+	}
 
-				//Remove sprites
-				for (auto sprite = sprites.begin(); sprite != sprites.end(); ++sprite)
-				{
-					RemoveSprite(*sprite);
-				}
-				return 0;
-			}
+	//Plays the frames once at the given location, the animation is recycled when it finishes
+	//Finished animations are pooled for each frame list so playing the same frames again creates no sprites
+	//While others of the same frames are still playing a new animation is needed, which loads its images
+	//unless enough instances have been preloaded with PreloadAnimation
+	//Returns false if any of the frames could not be loaded
+	bool ExEngine::PlayOnce(const std::vector<string>& frameList, const CVector3& position, const float tickRate, const EAnimationMode mode)
+	{
+		CFrameSet* frameSet = GetFrameSet(frameList);
+		std::unique_ptr<CAnimation> animation = frameSet->TakeIdleAnimation(mode);
+		if (animation)
+		{
+			animation->Restart(position, tickRate);
+			mOneShotAnimations.push_back(move(animation));
+			return true;
 		}
-		CAnimation* animation = new CAnimation(this, sprites, position, tickRate, looped);
-		mAnimations.push_back(unique_ptr<CAnimation>(animation));
-		return animation;
+
+		IAnimation* newAnimation = CreateAnimation(frameList, position, tickRate, false, mode);
+		if (!newAnimation) return false;
+
+		//Move it out of the user's animations into the one shots
+		mOneShotAnimations.push_back(mAnimations.Take(newAnimation));
+		return true;
+	}
+
+	//Loads enough sprites of every frame for the number of instances of the animation to be alive at once
+	//Creating that many with CreateAnimation or PlayOnce then never loads an image, unless they are Streamed
+	//The sprites are kept when the frame set cache is cleared
+	//Returns false if any of the frames could not be loaded
+	bool ExEngine::PreloadAnimation(const std::vector<string>& frameList, int instances)
+	{
+		return GetFrameSet(frameList)->Preload(instances);
 	}
 
 	//Removes the animation if found
 	void ExEngine::RemoveAnimation(IAnimation* pAnimation)
 	{
-		for (auto animation = mAnimations.begin(); animation != mAnimations.end(); ++animation)
+		RemoveAnimation(mAnimations.Find(pAnimation));
+	}
+
+	//Remove the animation if the handle isn't stale
+	void ExEngine::RemoveAnimation(AnimationHandle handle)
+	{
+		//The animation is destroyed as it goes out of scope
+		mAnimations.Take(handle);
+	}
+
+	//Returns a handle to the animation, or a null handle if it doesn't exist
+	AnimationHandle ExEngine::GetAnimationHandle(IAnimation* pAnimation)
+	{
+		return mAnimations.Find(pAnimation);
+	}
+
+	//Returns the animation of the handle, or 0 if it has been removed
+	IAnimation* ExEngine::GetAnimation(AnimationHandle handle)
+	{
+		return mAnimations.Get(handle);
+	}
+
+	//Starts placing the animation on screen where its parent is each time the scene is drawn
+	//Does nothing if the animation is already attached
+	void ExEngine::AttachAnimation(CAnimation* animation)
+	{
+		if (animation->mAttachSlot >= 0) return;
+
+		animation->mAttachSlot = static_cast<int>(mAttachedAnimations.size());
+		mAttachedAnimations.push_back(animation);
+	}
+
+	//Stops placing the animation where its parent is
+	//Does nothing if the animation isn't attached
+	void ExEngine::DetachAnimation(CAnimation* animation)
+	{
+		if (animation->mAttachSlot < 0) return;
+
+		//Swap the last animation into the gap, order doesn't matter
+		CAnimation* last = mAttachedAnimations.back();
+		mAttachedAnimations[animation->mAttachSlot] = last;
+		last->mAttachSlot = animation->mAttachSlot;
+		mAttachedAnimations.pop_back();
+		animation->mAttachSlot = -1;
+	}
+
+	//Works out where the world position is on screen from the camera the attached animations are being placed for
+	//Returns false if the position is behind the camera
+	bool ExEngine::ProjectToScreen(const CVector3& position, float& x, float& y)
+	{
+		const float* camera = mAttachCameraMatrix;
+		CVector3 offset(position.x - camera[12], position.y - camera[13], position.z - camera[14]);
+
+		//Distance along each of the camera's axes
+		float right = offset.x * camera[0] + offset.y * camera[1] + offset.z * camera[2];
+		float up = offset.x * camera[4] + offset.y * camera[5] + offset.z * camera[6];
+		float depth = offset.x * camera[8] + offset.y * camera[9] + offset.z * camera[10];
+		if (depth <= 0.0f) return false;
+
+		x = mAttachCentreX + right / depth * mAttachScale;
+		y = mAttachCentreY - up / depth * mAttachScale;
+		return true;
+	}
+
+	//Reads the file from the media folders in the background so loading it later doesn't wait on the disk
+	void ExEngine::PrefetchFile(const string& file)
+	{
+		mpFilePrefetcher->Prefetch(file);
+	}
+
+	//Returns the frame set shared by animations of the frame list, creating it if it doesn't exist
+	CFrameSet* ExEngine::GetFrameSet(const std::vector<string>& frameList)
+	{
+		string key;
+		for (auto frame = frameList.begin(); frame != frameList.end(); ++frame)
 		{
-			if ((*animation).get() == pAnimation)
-			{
-				mAnimations.erase(animation);
-				return;
-			}
+			key += *frame;
+			key += '|';
 		}
+
+		auto frameSet = mFrameSets.find(key);
+		if (frameSet != mFrameSets.end()) return frameSet->second.get();
+
+		CFrameSet* newFrameSet = new CFrameSet(this, frameList);
+		mFrameSets.insert(std::make_pair(key, unique_ptr<CFrameSet>(newFrameSet)));
+		return newFrameSet;
 	}
 
 	////////////////////
@@ -489,13 +634,11 @@ namespace tle
 	//Create a particle emitter at the given location
 	IParticleEmitter* ExEngine::CreateEmitter(EEmissionType type, const string& particleSprite, const float emissionRate, const CVector3& position)
 	{
-		tlx::ICamera* node = m_pSceneManager->CreateCamera();
-
-		CParticleEmitter* emitter = new CParticleEmitter(type, emissionRate, node, m_pSceneManager, this);
+		CParticleEmitter* emitter = new CParticleEmitter(type, emissionRate, this);
 		emitter->SetPosition(position.x, position.y, position.z);
 		emitter->SetParticleSkin(particleSprite);
 
-		mEmitters.push_back(std::unique_ptr<CParticleEmitter>(emitter));
+		mEmitters.Insert(std::unique_ptr<CParticleEmitter>(emitter));
 
 		return emitter;
 	}
@@ -503,45 +646,557 @@ namespace tle
 	//Create a particle emitter at the given location
 	IParticleEmitter* ExEngine::CreateEmitter(EEmissionType type, const std::vector<string>& particleSprite, const float emissionRate, const CVector3& position)
 	{
-		tlx::ICamera* node = m_pSceneManager->CreateCamera();
-
-		CParticleEmitter* emitter = new CParticleEmitter(type, emissionRate, node, m_pSceneManager, this);
+		CParticleEmitter* emitter = new CParticleEmitter(type, emissionRate, this);
 		emitter->SetPosition(position.x, position.y, position.z);
 		emitter->SetParticleSkin(particleSprite);
 
-		mEmitters.push_back(std::unique_ptr<CParticleEmitter>(emitter));
+		mEmitters.Insert(std::unique_ptr<CParticleEmitter>(emitter));
 
 		return emitter;
 	}
 
+	//Create a particle emitter from a template at the given location
+	//Reuses an idle emitter of the template if there is one
+	IParticleEmitter* ExEngine::CreateEmitter(IEmitterTemplate* pTemplate, const CVector3& position)
+	{
+		CEmitterTemplate* emitterTemplate = static_cast<CEmitterTemplate*>(pTemplate);
+		const SEmitterSettings& settings = emitterTemplate->GetSettings();
+
+		std::unique_ptr<CParticleEmitter> emitter = emitterTemplate->TakeIdleEmitter();
+		if (!emitter)
+		{
+			emitter.reset(new CParticleEmitter(settings.mType, settings.mEmissionRate, this));
+			emitter->ApplyTemplate(emitterTemplate);
+			if (settings.mReserve > 0) emitter->Reserve(settings.mReserve);
+		}
+		else
+		{
+			emitter->ApplyTemplate(emitterTemplate);
+		}
+
+		emitter->SetPosition(position.x, position.y, position.z);
+		if (settings.mPreWarm) emitter->PreWarm();
+
+		return mEmitters.Get(mEmitters.Insert(move(emitter)));
+	}
+
 	//Remove the particle emitter if it exists
-	void ExEngine::RemoveEmitter(IParticleEmitter* emitter)
+	//Emitters spawned from a template are kept for reuse
+	//A fade time of 0 or more cuts the life of the particles left alive to at most that many seconds
+	void ExEngine::RemoveEmitter(IParticleEmitter* emitter, const float fadeTime)
+	{
+		RemoveEmitter(mEmitters.Find(emitter), fadeTime);
+	}
+
+	//Remove the particle emitter if the handle isn't stale
+	//A fade time of 0 or more cuts the life of the particles left alive to at most that many seconds
+	void ExEngine::RemoveEmitter(EmitterHandle handle, const float fadeTime)
+	{
+		std::unique_ptr<CParticleEmitter> emitter = mEmitters.Take(handle);
+		if (!emitter) return;
+
+		//A removed emitter only lives on until its particles have died
+		//Its parent may be removed along with it, or already have been, so it is let go without reading the parent
+		emitter->Stop();
+		emitter->ReleaseParent();
+		if (fadeTime >= 0.0f) emitter->LimitParticleLife(fadeTime);
+
+		if (emitter->HasActiveParticles())
+		{
+			mDyingEmitters.push_back(move(emitter));
+		}
+		else
+		{
+			RecycleEmitter(move(emitter));
+		}
+	}
+
+	//Returns a handle to the particle emitter, or a null handle if it doesn't exist
+	EmitterHandle ExEngine::GetEmitterHandle(IParticleEmitter* emitter)
+	{
+		return mEmitters.Find(emitter);
+	}
+
+	//Returns the particle emitter of the handle, or 0 if it has been removed
+	IParticleEmitter* ExEngine::GetEmitter(EmitterHandle handle)
+	{
+		return mEmitters.Get(handle);
+	}
+
+	//Updates every live and dying emitter
+	//The particles are simulated in parallel, everything that calls into the TL-Engine is done on the main thread
+	void ExEngine::UpdateEmitters(float delta)
+	{
+		mUpdateEmitters.clear();
+		for (auto emitter = mEmitters.begin(); emitter != mEmitters.end(); ++emitter)
+		{
+			mUpdateEmitters.push_back(emitter->get());
+		}
+		for (auto emitter = mDyingEmitters.begin(); emitter != mDyingEmitters.end(); ++emitter)
+		{
+			//Finished emitters are only waiting to be reclaimed
+			if ((*emitter)->HasActiveParticles()) mUpdateEmitters.push_back(emitter->get());
+		}
+
+		//Read the emitter positions from the scene
+		for (auto emitter = mUpdateEmitters.begin(); emitter != mUpdateEmitters.end(); ++emitter)
+		{
+			(*emitter)->PrepareUpdate();
+		}
+
+		//Each emitter only touches its own particles so they can be simulated at the same time
+		std::vector<CParticleEmitter*>& emitters = mUpdateEmitters;
+		mpJobSystem->ParallelFor(static_cast<int>(emitters.size()), [&emitters, delta](int i)
+		{
+			emitters[i]->Simulate(delta);
+		});
+
+		//Move the models and swap their skins
+		for (auto emitter = mUpdateEmitters.begin(); emitter != mUpdateEmitters.end(); ++emitter)
+		{
+			(*emitter)->ApplyUpdate();
+		}
+	}
+
+	//Recycles or destroys dying emitters whose particles have all died
+	//Capped by the number of particle models handed back each frame so removing lots of emitters at once
+	//is spread over several frames, at least one emitter is always reclaimed
+	void ExEngine::ReclaimDyingEmitters()
 	{
-		for (auto it = mEmitters.begin(); it != mEmitters.end(); ++it)
+		int budget = kMaxReclaimedModelsPerFrame;
+		for (size_t i = 0; i < mDyingEmitters.size() && budget > 0; /*Only increment if no removal occurs*/)
 		{
-			if (emitter == it->get())
+			if (mDyingEmitters[i]->HasActiveParticles())
 			{
-				if ((*it)->HasActiveParticles())
-				{
-					mDyingEmitters.push_back(move(*it));
-				}
-				mEmitters.erase(it);
-				return;
+				++i;
+				continue;
 			}
+
+			budget -= mDyingEmitters[i]->GetInactiveParticleCount() + 1;
+			RecycleEmitter(move(mDyingEmitters[i]));
+
+			//Swap the last emitter into the gap, order doesn't matter
+			if (i + 1 < mDyingEmitters.size()) mDyingEmitters[i] = move(mDyingEmitters.back());
+			mDyingEmitters.pop_back();
 		}
 	}
-	
+
+	//Returns the animations started by PlayOnce that have finished to their frame set's pool
+	void ExEngine::RecycleOneShotAnimations()
+	{
+		for (size_t i = 0; i < mOneShotAnimations.size(); /*Only increment if no removal occurs*/)
+		{
+			if (!mOneShotAnimations[i]->HasEnded())
+			{
+				++i;
+				continue;
+			}
+
+			//Anything not taken by the pool is destroyed as it goes out of scope
+			std::unique_ptr<CAnimation> animation = move(mOneShotAnimations[i]);
+			animation->GetFrameSet()->ReturnIdleAnimation(move(animation));
+
+			//Swap the last animation into the gap, order doesn't matter
+			if (i + 1 < mOneShotAnimations.size()) mOneShotAnimations[i] = move(mOneShotAnimations.back());
+			mOneShotAnimations.pop_back();
+		}
+	}
+
+	//Places the animations attached to scene nodes where their nodes are on screen from the camera
+	//Only the animations whose node has moved are touched, unless the camera or window has changed
+	void ExEngine::PlaceAttachedAnimations(ICamera* camera)
+	{
+		if (mAttachedAnimations.empty()) return;
+
+		bool cameraMoved = camera != mpAttachCamera;
+		mpAttachCamera = camera;
+
+		float matrix[16];
+		camera->GetMatrix(matrix);
+		for (int i = 0; i < 16; ++i)
+		{
+			if (matrix[i] != mAttachCameraMatrix[i])
+			{
+				cameraMoved = true;
+				mAttachCameraMatrix[i] = matrix[i];
+			}
+		}
+
+		//Cameras are created with the smaller of their horizontal and vertical fields of view set to pi / 3.4
+		float centreX = 0.5f * static_cast<float>(GetWidth());
+		float centreY = 0.5f * static_cast<float>(GetHeight());
+		float scale = (centreX < centreY ? centreX : centreY) / tanf(tlx::kfPi / 6.8f);
+		if (centreX != mAttachCentreX || centreY != mAttachCentreY)
+		{
+			cameraMoved = true;
+			mAttachCentreX = centreX;
+			mAttachCentreY = centreY;
+			mAttachScale = scale;
+		}
+
+		for (auto animation = mAttachedAnimations.begin(); animation != mAttachedAnimations.end(); ++animation)
+		{
+			(*animation)->FollowParent(cameraMoved);
+		}
+	}
+
+	//Queues an event for every animation that finished during the last clock update
+	//One shot animations have no handle so are left out
+	void ExEngine::QueueFinishedAnimations()
+	{
+		const std::vector<CAnimation*>& finished = mAnimationClock.GetFinishedAnimations();
+		for (auto animation = finished.begin(); animation != finished.end(); ++animation)
+		{
+			AnimationHandle handle = mAnimations.Find(*animation);
+			if (handle.IsNull()) continue;
+
+			SEngineEvent event;
+			event.mType = AnimationFinished;
+			event.mAnimation = handle;
+			mEvents.push_back(event);
+		}
+	}
+
+	//Queues an event for every live emitter that has been stopped and has just lost its last particle
+	void ExEngine::QueueDrainedEmitters()
+	{
+		for (auto emitter = mEmitters.begin(); emitter != mEmitters.end(); ++emitter)
+		{
+			if (!(*emitter)->CheckDrained()) continue;
+
+			SEngineEvent event;
+			event.mType = EmitterDrained;
+			event.mEmitter = mEmitters.Find(emitter->get());
+			mEvents.push_back(event);
+		}
+	}
+
+	//Drops the oldest events if nobody is draining the queue
+	void ExEngine::TrimEvents()
+	{
+		while (mEvents.size() > kMaxQueuedEvents) mEvents.pop_front();
+	}
+
+	//Gives a removed emitter with no active particles back to its template's pool
+	//Emitters without a template, or whose template pool is full, are destroyed
+	void ExEngine::RecycleEmitter(std::unique_ptr<CParticleEmitter>&& emitter)
+	{
+		CEmitterTemplate* emitterTemplate = emitter->GetTemplate();
+		if (emitterTemplate) emitterTemplate->ReturnIdleEmitter(move(emitter));
+
+		//Anything not taken by the pool is destroyed here
+		emitter.reset();
+	}
+
+	//Returns the id of the texture, interning it if it hasn't been seen before
+	int ExEngine::GetTextureId(const string& texture)
+	{
+		auto it = mTextureIds.find(texture);
+		if (it != mTextureIds.end()) return it->second;
+
+		int id = static_cast<int>(mTextureNames.size());
+		mTextureIds.insert(std::pair<string, int>{texture, id});
+		mTextureNames.push_back(texture);
+		return id;
+	}
+
+	//Returns the name of an interned texture
+	const string& ExEngine::GetTextureName(int textureId)
+	{
+		return mTextureNames[textureId];
+	}
+
 	//Gives a pointer to a particle model (quad) that already has the given texture
-	IModel* ExEngine::GetParticleModel(const string& texture)
+	SParticleModel ExEngine::GetParticleModel(int textureId)
 	{
 		if (!mParticleMesh) mParticleMesh = ExEngine::LoadMesh(PARTICLE_MODEL);
-		return GetModel(mParticleMesh, texture);
+
+		//Returns a model from the particle model cache
+		if (textureId < static_cast<int>(mParticleModels.size()) && !mParticleModels[textureId].empty())
+		{
+			SParticleModel model = mParticleModels[textureId].back();
+			mParticleModels[textureId].pop_back();
+			return model;
+		}
+		else //Create a new model if there are none in the cache
+		{
+			return CreateParticleModel(textureId);
+		}
 	}
 
 	//Adds an unused particle model to the cache
-	void ExEngine::ReturnParticleModel(IModel* model, const string& texture)
+	void ExEngine::ReturnParticleModel(const SParticleModel& model, int textureId)
 	{
-		CacheModel(model, texture);
+		if (textureId >= static_cast<int>(mParticleModels.size())) mParticleModels.resize(mTextureNames.size());
+		mParticleModels[textureId].push_back(model);
+	}
+
+	//Creates particle models until the cache holds at least the amount with the given texture
+	void ExEngine::ReserveParticleModels(int textureId, int amount)
+	{
+		if (!mParticleMesh) mParticleMesh = ExEngine::LoadMesh(PARTICLE_MODEL);
+		if (textureId >= static_cast<int>(mParticleModels.size())) mParticleModels.resize(mTextureNames.size());
+
+		ParticleModelList& models = mParticleModels[textureId];
+		models.reserve(amount);
+		while (static_cast<int>(models.size()) < amount)
+		{
+			models.push_back(CreateParticleModel(textureId));
+		}
+	}
+
+	//Creates a particle quad with the texture and records the order it was created in
+	SParticleModel ExEngine::CreateParticleModel(int textureId)
+	{
+		IModel* model = mParticleMesh->CreateModel();
+
+		//Set the texture if not default
+		if (mTextureNames[textureId] != kDefaultTexture) model->SetSkin(mTextureNames[textureId]);
+
+		return SParticleModel{ model, mNextParticleModelOrder++ };
+	}
+
+	//Hands the quads of each texture out to the live particles back to front from the camera
+	//Quads are assumed to be drawn in the order they were created, so the oldest quad of each texture is
+	//given to the furthest particle with that texture. Different textures can't trade quads so are only
+	//ordered amongst themselves
+	//Also estimates the particle overdraw, assuming the particle quad is one unit across
+	void ExEngine::SortParticles(ICamera* camera)
+	{
+		float matrix[16];
+		camera->GetMatrix(matrix);
+
+		//Cameras look down their local z axis
+		CVector3 forward(matrix[8], matrix[9], matrix[10]);
+		float length = sqrtf(forward.x * forward.x + forward.y * forward.y + forward.z * forward.z);
+		if (length > 0.0f) forward = CVector3(forward.x / length, forward.y / length, forward.z / length);
+		CVector3 cameraPos(camera->GetX(), camera->GetY(), camera->GetZ());
+
+		//Fraction of the screen a quad of unit scale covers at unit depth
+		const float kCameraFOV = 3.14159265f / 3.4f; //Field of view TL-Xtreme cameras are created with
+		const float halfHeight = tanf(kCameraFOV / 2.0f);
+		const float aspect = static_cast<float>(m_pRenderDevice->GetSurfaceWidth()) / m_pRenderDevice->GetSurfaceHeight();
+		const float unitCoverage = 1.0f / (4.0f * halfHeight * halfHeight * aspect);
+
+		mSortEntries.clear();
+		mSortQuads.clear();
+		float minDepth = 0.0f;
+		float maxDepth = 0.0f;
+		float overdraw = 0.0f;
+
+		//Gather the sortable particles of an emitter
+		auto gather = [&](CParticleEmitter* emitter)
+		{
+			for (CParticle* particle = emitter->GetFirstActiveParticle(); particle; particle = particle->GetNext())
+			{
+				IModel* model = particle->GetSortableModel();
+				if (!model) continue;
+
+				CVector3 pos = particle->GetPosition();
+				float depth = (pos.x - cameraPos.x) * forward.x + (pos.y - cameraPos.y) * forward.y + (pos.z - cameraPos.z) * forward.z;
+
+				if (mSortEntries.empty() || depth < minDepth) minDepth = depth;
+				if (mSortEntries.empty() || depth > maxDepth) maxDepth = depth;
+
+				//Particles behind the camera or clipped by the near plane aren't drawn
+				if (depth > 0.1f)
+				{
+					float scale = particle->GetScale();
+					overdraw += unitCoverage * scale * scale / (depth * depth);
+				}
+
+				mSortEntries.push_back(SSortEntry{ 0, depth, particle });
+				mSortQuads.push_back(SSortQuad{ static_cast<unsigned int>(particle->GetModelOrder()), particle->GetModelTexture(), SParticleModel{ model, particle->GetModelOrder() } });
+			}
+		};
+		for (auto emitter = mEmitters.begin(); emitter != mEmitters.end(); ++emitter)
+		{
+			gather(emitter->get());
+		}
+		for (auto emitter = mDyingEmitters.begin(); emitter != mDyingEmitters.end(); ++emitter)
+		{
+			gather(emitter->get());
+		}
+
+		mSortedParticles = static_cast<int>(mSortEntries.size());
+		mParticleOverdraw = overdraw;
+		if (mSortEntries.size() < 2) return;
+
+		//Quantize the depths to 16 bits, furthest first
+		const float range = maxDepth - minDepth;
+		const float quantize = range > 0.0f ? 65535.0f / range : 0.0f;
+		for (auto entry = mSortEntries.begin(); entry != mSortEntries.end(); ++entry)
+		{
+			entry->mKey = static_cast<unsigned int>((maxDepth - entry->mDepth) * quantize);
+		}
+		RadixSort(mSortEntries, mSortScratch, 65535);
+
+		//Line up the quads in the order they are drawn, then group them by texture keeping that order
+		RadixSort(mSortQuads, mSortQuadScratch, static_cast<unsigned int>(mNextParticleModelOrder));
+		mSortQuadNext.assign(mTextureNames.size() + 1, 0);
+		for (auto quad = mSortQuads.begin(); quad != mSortQuads.end(); ++quad)
+		{
+			++mSortQuadNext[quad->mTexture + 1];
+		}
+		for (size_t i = 1; i < mSortQuadNext.size(); ++i)
+		{
+			mSortQuadNext[i] += mSortQuadNext[i - 1];
+		}
+		mSortQuadScratch.resize(mSortQuads.size());
+		for (auto quad = mSortQuads.begin(); quad != mSortQuads.end(); ++quad)
+		{
+			mSortQuadScratch[mSortQuadNext[quad->mTexture]++] = *quad;
+		}
+		mSortQuads.swap(mSortQuadScratch);
+
+		//The scatter left each texture's counter at the start of the next texture, step them back to their own start
+		for (size_t i = mSortQuadNext.size() - 1; i > 0; --i)
+		{
+			mSortQuadNext[i] = mSortQuadNext[i - 1];
+		}
+		mSortQuadNext[0] = 0;
+
+		//Give the particles the quads back to front
+		for (auto entry = mSortEntries.begin(); entry != mSortEntries.end(); ++entry)
+		{
+			int& next = mSortQuadNext[entry->mpParticle->GetModelTexture()];
+			entry->mpParticle->SwapModel(mSortQuads[next++].mModel);
+		}
+	}
+
+	//Sorts the items by their key with a least significant digit radix sort of 8 bits a pass
+	template<class T>
+	void ExEngine::RadixSort(std::vector<T>& items, std::vector<T>& scratch, unsigned int maxKey)
+	{
+		scratch.resize(items.size());
+		for (unsigned int shift = 0; shift < 32 && (maxKey >> shift) != 0; shift += 8)
+		{
+			int offsets[257] = { 0 };
+			for (auto item = items.begin(); item != items.end(); ++item)
+			{
+				++offsets[((item->mKey >> shift) & 0xFF) + 1];
+			}
+			for (int i = 1; i < 257; ++i)
+			{
+				offsets[i] += offsets[i - 1];
+			}
+			for (auto item = items.begin(); item != items.end(); ++item)
+			{
+				scratch[offsets[(item->mKey >> shift) & 0xFF]++] = *item;
+			}
+			items.swap(scratch);
+		}
+	}
+
+	/////////////////////
+	//Emitter Templates//
+
+	//Creates an immutable effect definition that emitters can be spawned from
+	IEmitterTemplate* ExEngine::CreateEmitterTemplate(const SEmitterSettings& settings)
+	{
+		CEmitterTemplate* emitterTemplate = new CEmitterTemplate(settings, this);
+		mEmitterTemplates.push_back(std::unique_ptr<CEmitterTemplate>(emitterTemplate));
+		return emitterTemplate;
+	}
+
+	//Loads an effect definition from a file of "setting value" lines
+	//Returns 0 if the file could not be loaded
+	//
+	//	type Sphere|Circle|Cone|Arch|Line
+	//	rate 0.01
+	//	angle 45
+	//	life 2
+	//	scale 0.5
+	//	velocity 0 0.1 0
+	//	acceleration 0 -0.001 0
+	//	skin Smoke0.png Smoke1.png Smoke2.png
+	//	flipbook 1
+	//	scalecurve 0.5 1 0
+	//	dragcurve 0 0.5
+	//	reserve 200
+	//	prewarm 1
+	IEmitterTemplate* ExEngine::LoadEmitterTemplate(const string& file)
+	{
+		string path = FindMediaFile(file);
+		std::ifstream in(path != "" ? path : file);
+		if (!in)
+		{
+			std::cout << "Could not load emitter template \"" + file + "\"" << std::endl;
+			return 0;
+		}
+
+		const string types[] = { "Sphere", "Circle", "Cone", "Arch", "Line" };
+
+		SEmitterSettings settings;
+		string line;
+		while (std::getline(in, line))
+		{
+			std::istringstream values(line);
+			string setting;
+			if (!(values >> setting) || setting[0] == '#') continue;
+
+			if (setting == "type")
+			{
+				string type;
+				values >> type;
+				for (int i = 0; i < 5; ++i)
+				{
+					if (type == types[i]) settings.mType = static_cast<EEmissionType>(i);
+				}
+			}
+			else if (setting == "rate") values >> settings.mEmissionRate;
+			else if (setting == "angle") values >> settings.mEmissionAngle;
+			else if (setting == "life") values >> settings.mParticleLife;
+			else if (setting == "scale") values >> settings.mParticleScale;
+			else if (setting == "velocity") values >> settings.mParticleVelocity.x >> settings.mParticleVelocity.y >> settings.mParticleVelocity.z;
+			else if (setting == "acceleration") values >> settings.mParticleAcceleration.x >> settings.mParticleAcceleration.y >> settings.mParticleAcceleration.z;
+			else if (setting == "reserve") values >> settings.mReserve;
+			else if (setting == "prewarm") values >> settings.mPreWarm;
+			else if (setting == "flipbook") values >> settings.mParticleFlipbook;
+			else if (setting == "scalecurve" || setting == "dragcurve")
+			{
+				std::vector<float>& keys = setting == "scalecurve" ? settings.mParticleScaleCurve : settings.mParticleDragCurve;
+				keys.clear();
+				float key;
+				while (values >> key) keys.push_back(key);
+			}
+			else if (setting == "skin")
+			{
+				settings.mParticleSkin.clear();
+				string texture;
+				while (values >> texture) settings.mParticleSkin.push_back(texture);
+			}
+			else
+			{
+				std::cout << "Unknown setting \"" + setting + "\" in emitter template \"" + file + "\"" << std::endl;
+			}
+		}
+
+		return CreateEmitterTemplate(settings);
+	}
+
+	//Removes the template and its idle emitters
+	//Emitters already spawned from it keep working
+	void ExEngine::RemoveEmitterTemplate(IEmitterTemplate* pTemplate)
+	{
+		for (auto it = mEmitterTemplates.begin(); it != mEmitterTemplates.end(); ++it)
+		{
+			if (it->get() == pTemplate)
+			{
+				//Live emitters keep the template's particle data alive themselves
+				for (auto emitter = mEmitters.begin(); emitter != mEmitters.end(); ++emitter)
+				{
+					if ((*emitter)->GetTemplate() == it->get()) (*emitter)->ClearTemplate();
+				}
+				for (auto emitter = mDyingEmitters.begin(); emitter != mDyingEmitters.end(); ++emitter)
+				{
+					if ((*emitter)->GetTemplate() == it->get()) (*emitter)->ClearTemplate();
+				}
+
+				mEmitterTemplates.erase(it);
+				return;
+			}
+		}
 	}
 
 	/////////
@@ -560,6 +1215,24 @@ namespace tle
 		mpSoundManager->RemoveSound(pSound);
 	}
 
+	//Removes the sound if the handle isn't stale
+	void ExEngine::RemoveSound(SoundHandle handle)
+	{
+		mpSoundManager->RemoveSound(handle);
+	}
+
+	//Returns a handle to the sound, or a null handle if it doesn't exist
+	SoundHandle ExEngine::GetSoundHandle(ISound* pSound)
+	{
+		return mpSoundManager->GetSoundHandle(pSound);
+	}
+
+	//Returns the sound of the handle, or 0 if it has been removed
+	ISound* ExEngine::GetSound(SoundHandle handle)
+	{
+		return mpSoundManager->GetSound(handle);
+	}
+
 	/////////
 	//Music//
 
@@ -576,6 +1249,38 @@ namespace tle
 		mpSoundManager->RemoveMusic(pMusic);
 	}
 
+	//Removes the music if the handle isn't stale
+	void ExEngine::RemoveMusic(MusicHandle handle)
+	{
+		mpSoundManager->RemoveMusic(handle);
+	}
+
+	//Returns a handle to the music, or a null handle if it doesn't exist
+	MusicHandle ExEngine::GetMusicHandle(IMusic* pMusic)
+	{
+		return mpSoundManager->GetMusicHandle(pMusic);
+	}
+
+	//Returns the music of the handle, or 0 if it has been removed
+	IMusic* ExEngine::GetMusic(MusicHandle handle)
+	{
+		return mpSoundManager->GetMusic(handle);
+	}
+
+	//////////
+	//Events//
+
+	//Takes the oldest event queued by Timer, returns false once there are none left
+	//Drain the queue once a frame instead of checking every object, if left undrained the oldest events are dropped
+	bool ExEngine::PollEvent(SEngineEvent& event)
+	{
+		if (mEvents.empty()) return false;
+
+		event = mEvents.front();
+		mEvents.pop_front();
+		return true;
+	}
+
 	/***************************************************
 					Additional Controls
 	****************************************************/
@@ -592,6 +1297,68 @@ namespace tle
 		mAutoUpdate = true;
 	}
 
+	//Updates every auto updated entity by the given time in seconds, even while auto updates are paused
+	//Ticks the animation clock, recycles finished one shot animations, updates live and dying emitters and
+	//queues the events they raise for PollEvent, which is the same work Timer does with the time it measures
+	//Timer only does it while auto updates aren't paused, so call PauseAutoUpdates first to run animations
+	//and particles at a fixed time step instead, otherwise both step them and they run too fast
+	//Sounds play on their own so still only raise events when Timer is called
+	void ExEngine::StepAutoUpdates(float delta)
+	{
+		//Update animations, only those running are on the clock
+		mAnimationClock.Update(delta);
+		QueueFinishedAnimations();
+		RecycleOneShotAnimations();
+
+		//Update emitters
+		UpdateEmitters(delta);
+		QueueDrainedEmitters();
+
+		//Remove dying emitters that have finished
+		ReclaimDyingEmitters();
+
+		//Drop the oldest events if nobody is draining the queue
+		TrimEvents();
+	}
+
+	//Draws particles back to front across all emitters so blended particles overlap correctly
+	//Also measures the particle overdraw reported by GetStats, off by default
+	void ExEngine::SetParticleSorting(bool sort)
+	{
+		mSortParticles = sort;
+		mSortedParticles = 0;
+		mParticleOverdraw = 0.0f;
+	}
+
+	//Returns true if particles are being sorted
+	bool ExEngine::GetParticleSorting()
+	{
+		return mSortParticles;
+	}
+
+	//Sets how far past the left and top of the window an animation can be before it is culled
+	//Culled animations keep playing but don't touch their sprites until they come back into view
+	//Should be at least the size of the largest animation frame, a negative margin turns culling off
+	void ExEngine::SetAnimationCullMargin(float margin)
+	{
+		mAnimationCullMargin = margin;
+
+		for (auto animation = mAnimations.begin(); animation != mAnimations.end(); ++animation)
+		{
+			(*animation)->UpdateCulling();
+		}
+		for (auto animation = mOneShotAnimations.begin(); animation != mOneShotAnimations.end(); ++animation)
+		{
+			(*animation)->UpdateCulling();
+		}
+	}
+
+	//Returns how far past the left and top of the window an animation can be before it is culled
+	float ExEngine::GetAnimationCullMargin()
+	{
+		return mAnimationCullMargin;
+	}
+
 	//Destroys all models and only models in the cache
 	void ExEngine::ClearModelCache()
 	{
@@ -604,14 +1371,36 @@ namespace tle
 			modelList->second.clear();
 		}
 		mModelCache.clear();
+
+		for (auto particleList = mParticleModels.begin(); particleList != mParticleModels.end(); ++particleList)
+		{
+			for (auto particle = particleList->begin(); particle != particleList->end(); ++particle)
+			{
+				particle->mpModel->GetMesh()->RemoveModel(particle->mpModel);
+			}
+		}
+		mParticleModels.clear();
+	}
+
+	//Removes the sprites and finished one shot animations kept for reuse by animations that have been removed
+	void ExEngine::ClearFrameSetCache()
+	{
+		for (auto frameSet = mFrameSets.begin(); frameSet != mFrameSets.end(); ++frameSet)
+		{
+			frameSet->second->ClearIdleSprites();
+		}
 	}
 
 	//Destroys all meshes and therefore all models and particle emitters
 	void ExEngine::ClearMeshCache()
 	{
 		//Destroy the emitters
-		mEmitters.clear();
+		mEmitters.Clear();
 		mDyingEmitters.clear();
+		for (auto emitterTemplate = mEmitterTemplates.begin(); emitterTemplate != mEmitterTemplates.end(); ++emitterTemplate)
+		{
+			(*emitterTemplate)->ClearIdleEmitters();
+		}
 
 		//Set the particle mesh back to null
 		mParticleMesh = 0;
@@ -651,6 +1440,129 @@ namespace tle
 		return mpSoundManager->GetVolume(type);
 	}
 
+	/***************************************************
+						Diagnostics
+	****************************************************/
+
+	//Returns the number of objects of each subsystem and their estimated memory usage
+	SEngineStats ExEngine::GetStats()
+	{
+		//Overhead of a node in a std::list or std::unordered_map bucket chain
+		const size_t nodeBytes = 2 * sizeof(void*);
+
+		SEngineStats stats = SEngineStats();
+
+		//Meshes & models
+		stats.mMeshes = static_cast<int>(mMeshMap.size());
+		for (auto mesh = mMeshMap.begin(); mesh != mMeshMap.end(); ++mesh)
+		{
+			stats.mModelCacheBytes += sizeof(IMesh*) + mesh->first.capacity() + nodeBytes;
+		}
+		for (auto modelList = mModelCache.begin(); modelList != mModelCache.end(); ++modelList)
+		{
+			stats.mCachedModels += static_cast<int>(modelList->second.size());
+			stats.mModelCacheBytes += sizeof(ModelKeyList) + modelList->first.second.capacity() + nodeBytes;
+			stats.mModelCacheBytes += modelList->second.capacity() * sizeof(IModel*);
+		}
+		for (auto particleList = mParticleModels.begin(); particleList != mParticleModels.end(); ++particleList)
+		{
+			stats.mCachedModels += static_cast<int>(particleList->size());
+			stats.mModelCacheBytes += sizeof(ParticleModelList) + particleList->capacity() * sizeof(SParticleModel);
+		}
+		for (auto texture = mTextureNames.begin(); texture != mTextureNames.end(); ++texture)
+		{
+			stats.mModelCacheBytes += 2 * (sizeof(string) + texture->capacity()) + sizeof(int) + nodeBytes;
+		}
+
+		//Particles & emitters
+		stats.mEmitters = mEmitters.Size();
+		stats.mDyingEmitters = static_cast<int>(mDyingEmitters.size());
+		for (auto emitter = mEmitters.begin(); emitter != mEmitters.end(); ++emitter)
+		{
+			stats.mActiveParticles += (*emitter)->GetActiveParticleCount();
+			stats.mInactiveParticles += (*emitter)->GetInactiveParticleCount();
+			stats.mParticleBytes += (*emitter)->GetMemoryUsage();
+		}
+		for (auto emitter = mDyingEmitters.begin(); emitter != mDyingEmitters.end(); ++emitter)
+		{
+			stats.mActiveParticles += (*emitter)->GetActiveParticleCount();
+			stats.mInactiveParticles += (*emitter)->GetInactiveParticleCount();
+			stats.mParticleBytes += (*emitter)->GetMemoryUsage();
+		}
+		for (auto emitterTemplate = mEmitterTemplates.begin(); emitterTemplate != mEmitterTemplates.end(); ++emitterTemplate)
+		{
+			stats.mPooledEmitters += (*emitterTemplate)->GetIdleEmitterCount();
+			stats.mParticleBytes += (*emitterTemplate)->GetMemoryUsage();
+		}
+		stats.mSortedParticles = mSortedParticles;
+		stats.mParticleOverdraw = mParticleOverdraw;
+		stats.mParticleBytes += (mSortEntries.capacity() + mSortScratch.capacity()) * sizeof(SSortEntry);
+		stats.mParticleBytes += (mSortQuads.capacity() + mSortQuadScratch.capacity()) * sizeof(SSortQuad) + mSortQuadNext.capacity() * sizeof(int);
+
+		//Animations & sprites
+		stats.mAnimations = mAnimations.Size();
+		for (auto animation = mAnimations.begin(); animation != mAnimations.end(); ++animation)
+		{
+			stats.mAnimationSprites += (*animation)->GetSpriteCount();
+			stats.mAnimationBytes += (*animation)->GetMemoryUsage();
+		}
+		stats.mAnimationBytes += mAnimationClock.GetMemoryUsage();
+		stats.mOneShotAnimations = static_cast<int>(mOneShotAnimations.size());
+		for (auto animation = mOneShotAnimations.begin(); animation != mOneShotAnimations.end(); ++animation)
+		{
+			stats.mAnimationBytes += (*animation)->GetMemoryUsage();
+		}
+		for (auto frameSet = mFrameSets.begin(); frameSet != mFrameSets.end(); ++frameSet)
+		{
+			stats.mPooledSprites += frameSet->second->GetIdleSpriteCount();
+			stats.mPooledAnimations += frameSet->second->GetIdleAnimationCount();
+			stats.mAnimationBytes += frameSet->second->GetMemoryUsage();
+		}
+		stats.mSprites = static_cast<int>(m_Sprites.size());
+
+		//Sound & music
+		stats.mSoundBuffers = mpSoundManager->GetSoundBufferCount();
+		stats.mSounds = mpSoundManager->GetSoundCount();
+		stats.mSoundBufferBytes = mpSoundManager->GetSoundBufferBytes();
+		stats.mMusic = mpSoundManager->GetMusicCount();
+		stats.mMusicBytes = mpSoundManager->GetMusicBytes();
+
+		stats.mTotalBytes = stats.mModelCacheBytes + stats.mParticleBytes + stats.mAnimationBytes +
+							stats.mSoundBufferBytes + stats.mMusicBytes;
+
+		return stats;
+	}
+
+	//Writes out any objects that were never removed by the user
+	//Called on destruction before everything is cleaned up
+	void ExEngine::LogLeaks()
+	{
+		SEngineStats stats = GetStats();
+
+		if (stats.mEmitters)
+		{
+			std::cout << "ExEngine: " << stats.mEmitters << " particle emitter(s) were never removed" << std::endl;
+		}
+		if (stats.mDyingEmitters)
+		{
+			std::cout << "ExEngine: " << stats.mDyingEmitters << " removed particle emitter(s) still had "
+					  << "active particles on shutdown" << std::endl;
+		}
+		if (stats.mAnimations)
+		{
+			std::cout << "ExEngine: " << stats.mAnimations << " animation(s) holding " << stats.mAnimationSprites
+					  << " sprite(s) were never removed" << std::endl;
+		}
+		if (stats.mSounds)
+		{
+			std::cout << "ExEngine: " << stats.mSounds << " sound(s) were never removed" << std::endl;
+		}
+		if (stats.mMusic)
+		{
+			std::cout << "ExEngine: " << stats.mMusic << " music object(s) were never removed" << std::endl;
+		}
+	}
+
 	/***************************************************
 						Destructor
 	****************************************************/
@@ -658,8 +1570,16 @@ namespace tle
 	//Ensure all memory is released
 	ExEngine::~ExEngine()
 	{
-		mAnimations.clear();
+		LogLeaks();
+
+		//Animations hand their sprites back to the frame sets so must go first
+		mAnimations.Clear();
+		mOneShotAnimations.clear();
+		mFrameSets.clear();
 		ClearMeshCache();
+
 		delete mpSoundManager;
+		delete mpJobSystem;
+		delete mpFilePrefetcher;
 	}
 }
\ No newline at end of file
@@ -1,8 +1,12 @@
 #pragma once
 #include "TLXEngineModified.h"
 #include "CParticleEmitter.h"
+#include "CEmitterTemplate.h"
 #include "CAnimation.h"
 #include "CSoundManager.h"
+#include "CJobSystem.h"
+#include "CFilePrefetcher.h"
+#include "CSlotMap.h"
 #include <unordered_map>
 #include <deque>
 
@@ -15,7 +19,7 @@ namespace tle
 	private:
 		//Declare model cache types
 		using ModelKey = std::pair<IMesh*, string>;
-		using ModelList = std::list<IModel*>;
+		using ModelList = std::vector<IModel*>; //Only ever pushed and popped from the back so never frees its storage
 		using ModelKeyList = std::pair<ModelKey, ModelList>;
 
 		//Hasher for ModelKey
@@ -34,13 +38,65 @@ namespace tle
 		//Model & mesh cache
 		std::unordered_map<string, IMesh*> mMeshMap;
 		std::unordered_map<ModelKey, ModelList, ModelKeyHasher> mModelCache;
-		vector_ptr<CAnimation> mAnimations;
+		CAnimationClock mAnimationClock; //Must outlive the animations
+		CSlotMap<CAnimation, IAnimation> mAnimations;
+		std::unordered_map<string, unique_ptr<CFrameSet>> mFrameSets; //Keyed by the frame list joined with '|'
+		vector_ptr<CAnimation> mOneShotAnimations; //Unordered, removed by swapping with the last
+		float mAnimationCullMargin;
+
+		//Animations following scene nodes, placed on screen when the scene is drawn
+		std::vector<CAnimation*> mAttachedAnimations; //Unordered, removed by swapping with the last
+		ICamera* mpAttachCamera; //Camera the attached animations were last placed for
+		float mAttachCameraMatrix[16];
+		float mAttachCentreX;
+		float mAttachCentreY;
+		float mAttachScale; //Pixels from the centre of the screen to a point one unit to the side and one unit in front of the camera
 
 		//Particles & Emitters
-		vector_ptr<CParticleEmitter> mEmitters;
-		vector_ptr<CParticleEmitter> mDyingEmitters;
+		CSlotMap<CParticleEmitter, IParticleEmitter> mEmitters;
+		vector_ptr<CParticleEmitter> mDyingEmitters; //Unordered, removed by swapping with the last
+		static const int kMaxReclaimedModelsPerFrame = 512;
+		vector_ptr<CEmitterTemplate> mEmitterTemplates;
 		IMesh* mParticleMesh;
 
+		//Particle textures are interned so particles can look up their models by index instead of hashing names
+		std::unordered_map<string, int> mTextureIds;
+		std::vector<string> mTextureNames;
+		using ParticleModelList = std::vector<SParticleModel>;
+		std::vector<ParticleModelList> mParticleModels; //Particle model cache indexed by texture id
+		int mNextParticleModelOrder;
+
+		//Particle sorting
+		//Quads of the same texture are handed out to particles back to front in the order the quads were created
+		struct SSortEntry
+		{
+			unsigned int mKey; //Quantized depth, smallest is furthest from the camera
+			float mDepth;
+			CParticle* mpParticle;
+		};
+		struct SSortQuad
+		{
+			unsigned int mKey; //Creation order of the quad
+			int mTexture;
+			SParticleModel mModel;
+		};
+		bool mSortParticles;
+		std::vector<SSortEntry> mSortEntries;
+		std::vector<SSortEntry> mSortScratch;
+		std::vector<SSortQuad> mSortQuads;
+		std::vector<SSortQuad> mSortQuadScratch;
+		std::vector<int> mSortQuadNext; //Next quad to hand out for each texture
+		int mSortedParticles;
+		float mParticleOverdraw;
+
+		//Emitters are simulated in parallel on the job system, the list is kept to avoid reallocating every frame
+		CJobSystem* mpJobSystem;
+		std::vector<CParticleEmitter*> mUpdateEmitters;
+
+		//Events queued by Timer waiting to be polled
+		std::deque<SEngineEvent> mEvents;
+		static const int kMaxQueuedEvents = 4096;
+
 		//Load Queue
 		struct ModelLoadToken
 		{
@@ -55,6 +111,9 @@ namespace tle
 		//Sound
 		CSoundManager* mpSoundManager;
 
+		//Reads the files of streamed animation frames in the background
+		CFilePrefetcher* mpFilePrefetcher;
+
 		bool mAutoUpdate;
 
 	public:
@@ -71,6 +130,16 @@ namespace tle
 		//Removes the mesh if found, all models of the mesh will also be deleted
 		virtual void RemoveMesh(const IMesh* pMesh);
 
+		// Add a folder to the list of folders searched for media
+		virtual void AddMediaFolder(const string& sFolder);
+
+		// Remove a folder from the list of folders searched for media, returns
+		// true on success (folder was found and removed)
+		virtual bool RemoveMediaFolder(const string& sFolder);
+
+		// Clears the list of folders searched for media
+		virtual void ClearMediaFolders();
+
 		// Draw everything in the scene from the viewpoint of the given camera.
 		// If no camera is supplied, the most recently created camera is used.
 		virtual void DrawScene(ICamera* pCamera = 0);
@@ -127,10 +196,13 @@ namespace tle
 		//Creates an animation at the given location
 		//Runs through the frames at a tick rate
 		//Return 0 if failed to load any of the animation frames
+		//Sprites parked by removed animations of the same frames are reused, any more needed are loaded
+		//Use PreloadAnimation so creating several instances at once doesn't load images
 		virtual IAnimation* CreateAnimation(const std::vector<string>& frameList,
 							const CVector3& position	= CVector3(0.0f, 0.0f, 0.0f),	/*Default location is the origin*/
 							const float		tickRate	= 0.1f,							/*Default rate is 10 frames per second*/
-							const bool		looped		= true							/*Set to loop the frames by default*/
+							const bool		looped		= true,							/*Set to loop the frames by default*/
+							const EAnimationMode mode	= AllFrames					/*Hold a sprite of every frame by default*/
 						);
 
 		//Creates an animation at the given location
@@ -139,12 +211,58 @@ namespace tle
 		virtual IAnimation* CreateAnimation(string& name, string& extension, int amount,
 							const CVector3& position	= CVector3(0.0f, 0.0f, 0.0f),	/*Default location is the origin*/
 							const float		tickRate	= 0.1f,							/*Default rate is 10 frames per second*/
-							const bool		looped		= true							/*Set to loop the frames by default*/
+							const bool		looped		= true,							/*Set to loop the frames by default*/
+							const EAnimationMode mode	= AllFrames					/*Hold a sprite of every frame by default*/
 						);
 
+		//Plays the frames once at the given location, the animation is recycled when it finishes
+		//Finished animations are pooled for each frame list so playing the same frames again creates no sprites
+		//While others of the same frames are still playing a new animation is needed, which loads its images
+		//unless enough instances have been preloaded with PreloadAnimation
+		//Returns false if any of the frames could not be loaded
+		virtual bool PlayOnce(const std::vector<string>& frameList,
+							const CVector3& position	= CVector3(0.0f, 0.0f, 0.0f),	/*Default location is the origin*/
+							const float		tickRate	= 0.1f,							/*Default rate is 10 frames per second*/
+							const EAnimationMode mode	= AllFrames					/*Hold a sprite of every frame by default*/
+							);
+
+		//Loads enough sprites of every frame for the number of instances of the animation to be alive at once
+		//Creating that many with CreateAnimation or PlayOnce then never loads an image, unless they are Streamed
+		//The sprites are kept when the frame set cache is cleared
+		//Returns false if any of the frames could not be loaded
+		virtual bool PreloadAnimation(const std::vector<string>& frameList, int instances);
+
 		//Remove the animation if it exists
+		//The pointer can't be checked for staleness, use a handle if the animation may already have been removed
 		virtual void RemoveAnimation(IAnimation* pAnimation);
 
+		//Remove the animation if the handle isn't stale
+		virtual void RemoveAnimation(AnimationHandle handle);
+
+		//Returns a handle to the animation, or a null handle if it doesn't exist
+		virtual AnimationHandle GetAnimationHandle(IAnimation* pAnimation);
+
+		//Returns the animation of the handle, or 0 if it has been removed
+		virtual IAnimation* GetAnimation(AnimationHandle handle);
+
+		//Returns the frame set shared by animations of the frame list, creating it if it doesn't exist
+		CFrameSet* GetFrameSet(const std::vector<string>& frameList);
+
+		//Reads the file from the media folders in the background so loading it later doesn't wait on the disk
+		void PrefetchFile(const string& file);
+
+		//Starts placing the animation on screen where its parent is each time the scene is drawn
+		//Does nothing if the animation is already attached
+		void AttachAnimation(CAnimation* animation);
+
+		//Stops placing the animation where its parent is
+		//Does nothing if the animation isn't attached
+		void DetachAnimation(CAnimation* animation);
+
+		//Works out where the world position is on screen from the camera the attached animations are being placed for
+		//Returns false if the position is behind the camera
+		bool ProjectToScreen(const CVector3& position, float& x, float& y);
+
 		////////////////////
 		//Particle Emitter//
 
@@ -162,14 +280,101 @@ namespace tle
 							const CVector3& position		= CVector3(0.0f, 0.0f, 0.0f)	/*Default location is the origin*/
 						);
 
+		//Create a particle emitter from a template at the given location
+		//Reuses an idle emitter of the template if there is one
+		virtual IParticleEmitter* CreateEmitter(IEmitterTemplate* pTemplate,
+							const CVector3& position		= CVector3(0.0f, 0.0f, 0.0f)	/*Default location is the origin*/
+						);
+
 		//Remove the particle emitter if it exists
-		virtual void RemoveEmitter(IParticleEmitter* emitter);
+		//The emitter stops and is kept until its particles have died, emitters spawned from a template are then kept for reuse
+		//A fade time of 0 or more cuts the life of the particles left alive to at most that many seconds
+		//The pointer can't be checked for staleness, pooled emitters are reissued at the same address,
+		//use a handle if the emitter may already have been removed
+		virtual void RemoveEmitter(IParticleEmitter* emitter, const float fadeTime = -1.0f);
+
+		//Remove the particle emitter if the handle isn't stale
+		//A fade time of 0 or more cuts the life of the particles left alive to at most that many seconds
+		virtual void RemoveEmitter(EmitterHandle handle, const float fadeTime = -1.0f);
+
+		//Returns a handle to the particle emitter, or a null handle if it doesn't exist
+		virtual EmitterHandle GetEmitterHandle(IParticleEmitter* emitter);
+
+		//Returns the particle emitter of the handle, or 0 if it has been removed
+		virtual IParticleEmitter* GetEmitter(EmitterHandle handle);
+
+		//Returns the id of the texture, interning it if it hasn't been seen before
+		virtual int GetTextureId(const string& texture);
+
+		//Returns the name of an interned texture
+		virtual const string& GetTextureName(int textureId);
 
 		//Gives a pointer to a particle model (quad) that already has the given texture
-		virtual IModel* GetParticleModel(const string& texture);
+		virtual SParticleModel GetParticleModel(int textureId);
 
 		//Adds an unused particle model to the cache
-		virtual void ReturnParticleModel(IModel* model, const string& texture);
+		virtual void ReturnParticleModel(const SParticleModel& model, int textureId);
+
+		//Creates particle models until the cache holds at least the amount with the given texture
+		virtual void ReserveParticleModels(int textureId, int amount);
+
+		/////////////////////
+		//Emitter Templates//
+
+		//Creates an immutable effect definition that emitters can be spawned from
+		virtual IEmitterTemplate* CreateEmitterTemplate(const SEmitterSettings& settings);
+
+		//Loads an effect definition from a file of "setting value" lines
+		//Returns 0 if the file could not be loaded
+		virtual IEmitterTemplate* LoadEmitterTemplate(const string& file);
+
+		//Removes the template and its idle emitters
+		//Emitters already spawned from it keep working
+		virtual void RemoveEmitterTemplate(IEmitterTemplate* pTemplate);
+
+	private:
+		//Creates a particle quad with the texture and records the order it was created in
+		SParticleModel CreateParticleModel(int textureId);
+
+		//Hands the quads of each texture out to the live particles back to front from the camera
+		//Also estimates the particle overdraw
+		void SortParticles(ICamera* camera);
+
+		//Sorts the items by their key with a least significant digit radix sort of 8 bits a pass
+		//Only the passes needed to cover the largest key are run, items with the same key keep their order
+		template<class T>
+		static void RadixSort(std::vector<T>& items, std::vector<T>& scratch, unsigned int maxKey);
+
+		//Updates every live and dying emitter
+		//The particles are simulated in parallel, everything that calls into the TL-Engine is done on the main thread
+		void UpdateEmitters(float delta);
+
+		//Recycles or destroys dying emitters whose particles have all died
+		//Capped by the number of particle models handed back each frame
+		void ReclaimDyingEmitters();
+
+		//Gives a removed emitter with no active particles back to its template's pool
+		//Emitters without a template, or whose template pool is full, are destroyed
+		void RecycleEmitter(std::unique_ptr<CParticleEmitter>&& emitter);
+
+		//Returns the animations started by PlayOnce that have finished to their frame set's pool
+		void RecycleOneShotAnimations();
+
+		//Places the animations attached to scene nodes where their nodes are on screen from the camera
+		//Only the animations whose node has moved are touched, unless the camera or window has changed
+		void PlaceAttachedAnimations(ICamera* camera);
+
+		//Queues an event for every animation that finished during the last clock update
+		//One shot animations have no handle so are left out
+		void QueueFinishedAnimations();
+
+		//Queues an event for every live emitter that has been stopped and has just lost its last particle
+		void QueueDrainedEmitters();
+
+		//Drops the oldest events if nobody is draining the queue
+		void TrimEvents();
+
+	public:
 
 		/////////
 		//Sound//
@@ -179,8 +384,18 @@ namespace tle
 		virtual ISound* CreateSound(const std::string& soundFile);
 
 		//Removes the sound if it exists
+		//The pointer can't be checked for staleness, use a handle if the sound may already have been removed
 		virtual void RemoveSound(ISound* pSound);
 
+		//Removes the sound if the handle isn't stale
+		virtual void RemoveSound(SoundHandle handle);
+
+		//Returns a handle to the sound, or a null handle if it doesn't exist
+		virtual SoundHandle GetSoundHandle(ISound* pSound);
+
+		//Returns the sound of the handle, or 0 if it has been removed
+		virtual ISound* GetSound(SoundHandle handle);
+
 		/////////
 		//Music//
 
@@ -189,8 +404,25 @@ namespace tle
 		virtual IMusic* CreateMusic(const std::string& musicFile);
 
 		//Removes the music if it exists
+		//The pointer can't be checked for staleness, use a handle if the music may already have been removed
 		virtual void RemoveMusic(IMusic* pMusic);
 
+		//Removes the music if the handle isn't stale
+		virtual void RemoveMusic(MusicHandle handle);
+
+		//Returns a handle to the music, or a null handle if it doesn't exist
+		virtual MusicHandle GetMusicHandle(IMusic* pMusic);
+
+		//Returns the music of the handle, or 0 if it has been removed
+		virtual IMusic* GetMusic(MusicHandle handle);
+
+		//////////
+		//Events//
+
+		//Takes the oldest event queued by Timer, returns false once there are none left
+		//Drain the queue once a frame instead of checking every object, if left undrained the oldest events are dropped
+		virtual bool PollEvent(SEngineEvent& event);
+
 		/***************************************************
 						Additional Controls
 		****************************************************/
@@ -201,9 +433,35 @@ namespace tle
 		//Unpauses any auto updated entities eg animations and particles
 		virtual void UnpauseAutoUpdates();
 
+		//Updates every auto updated entity by the given time in seconds, even while auto updates are paused
+		//Ticks the animation clock, recycles finished one shot animations, updates live and dying emitters and
+		//queues the events they raise for PollEvent, which is the same work Timer does with the time it measures
+		//Timer only does it while auto updates aren't paused, so call PauseAutoUpdates first to run animations
+		//and particles at a fixed time step instead, otherwise both step them and they run too fast
+		//Sounds play on their own so still only raise events when Timer is called
+		virtual void StepAutoUpdates(float delta);
+
+		//Draws particles back to front across all emitters so blended particles overlap correctly
+		//Also measures the particle overdraw reported by GetStats, off by default
+		virtual void SetParticleSorting(bool sort);
+
+		//Returns true if particles are being sorted
+		virtual bool GetParticleSorting();
+
+		//Sets how far past the left and top of the window an animation can be before it is culled
+		//Culled animations keep playing but don't touch their sprites until they come back into view
+		//Should be at least the size of the largest animation frame, a negative margin turns culling off
+		virtual void SetAnimationCullMargin(float margin);
+
+		//Returns how far past the left and top of the window an animation can be before it is culled
+		virtual float GetAnimationCullMargin();
+
 		//Destroys all models and only models in the cache
 		virtual void ClearModelCache();
 
+		//Removes the sprites and finished one shot animations kept for reuse by animations that have been removed
+		virtual void ClearFrameSetCache();
+
 		//Destroys all meshes and therefore all models and particle emitters
 		virtual void ClearMeshCache();
 
@@ -219,6 +477,19 @@ namespace tle
 		//Gets the volume for the specific volume modifier
 		virtual float GetVolume(SoundType type);
 
+		/***************************************************
+							Diagnostics
+		****************************************************/
+
+		//Returns the number of objects of each subsystem and their estimated memory usage
+		virtual SEngineStats GetStats();
+
+	private:
+		//Writes out any objects that were never removed by the user
+		//Called on destruction before everything is cleaned up
+		void LogLeaks();
+
+	public:
 		/***************************************************
 							Destructor
 		****************************************************/
@@ -3,6 +3,14 @@
 
 namespace tle
 {
+	class ISceneNode;
+
+	//AllFrames keeps a sprite of every frame, changing frame moves one sprite off screen and the next on
+	//SingleSprite only holds the sprite being shown, swapping it with the frame set's parked sprites when the frame changes
+	//Streamed holds a small window of frames from the one shown, loading one frame each time the frame changes and removing frames as they leave it,
+	//for long sequences that would take too long to load or too much memory to keep. Only the first frame is loaded on creation
+	enum EAnimationMode { AllFrames, SingleSprite, Streamed };
+
 	class IAnimation
 	{
 	public:
@@ -25,12 +33,21 @@ namespace tle
 		virtual bool IsPaused() = 0;
 		virtual bool IsLooped() = 0;
 		virtual bool HasEnded() = 0;
+		virtual EAnimationMode GetMode() = 0;
 
 		virtual void MoveX(float xMovement) = 0;
 		virtual void MoveY(float yMovement) = 0;
 		virtual void MoveZ(float zMovement) = 0;
 		virtual void Move(const tlx::CVector3& movement) = 0;
 
+		//Makes the animation follow the scene node on screen, the offset is relative to the node and turns with it
+		//The engine places attached animations once a frame when the scene is drawn, skipping those whose node and camera haven't moved
+		//While attached the x and y position are set by the engine, the z position is still the animation's depth
+		virtual void AttachTo(ISceneNode* parent, const tlx::CVector3& offset = tlx::CVector3(0.0f, 0.0f, 0.0f)) = 0;
+
+		//Stops the animation following the scene node, it stays where it was last placed
+		virtual void Detach() = 0;
+
 		virtual ~IAnimation() {}
 	};
 }
\ No newline at end of file
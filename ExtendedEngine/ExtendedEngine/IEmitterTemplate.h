@@ -0,0 +1,42 @@
+#pragma once
+#include "IParticleEmitter.h"
+
+namespace tle
+{
+	//Settings shared by every emitter spawned from a template
+	struct SEmitterSettings
+	{
+		//Emitter
+		EEmissionType mType = EEmissionType::Line; //Line emits along the emitter's own axes
+		float mEmissionRate = 0.01f;
+		float mEmissionAngle = 0.0f;
+
+		//Particle
+		float mParticleLife = 1.0f;
+		float mParticleScale = 1.0f;
+		CVector3 mParticleVelocity = CVector3(0.0f, 0.0f, 0.0f);
+		CVector3 mParticleAcceleration = CVector3(0.0f, 0.0f, 0.0f);
+		std::vector<string> mParticleSkin = std::vector<string>(1, PARTICLE_TEXTURE);
+		bool mParticleFlipbook = false; //See IParticleEmitter::SetParticleFlipbook
+		std::vector<float> mParticleScaleCurve; //See IParticleEmitter::SetParticleScaleCurve
+		std::vector<float> mParticleDragCurve; //See IParticleEmitter::SetParticleDragCurve
+
+		//Particles reserved by every new emitter, see IParticleEmitter::Reserve
+		int mReserve = 0;
+
+		//Simulate a particle life time when an emitter is spawned, see IParticleEmitter::PreWarm
+		bool mPreWarm = false;
+	};
+
+	//An immutable effect definition that many emitters can be spawned from
+	//Emitters of a template share its particle data until one of their particle settings is changed
+	//Removed emitters of a template are pooled and handed back out by the engine
+	class IEmitterTemplate
+	{
+	public:
+		//Returns the settings the template was created with
+		virtual const SEmitterSettings& GetSettings() = 0;
+
+		virtual ~IEmitterTemplate() {};
+	};
+}
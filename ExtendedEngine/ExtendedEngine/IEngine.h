@@ -2,13 +2,69 @@
 #include "TL-Engine.h"
 #include "IAnimation.h"
 #include "IParticleEmitter.h"
+#include "IEmitterTemplate.h"
 #include "ISound.h"
 #include "IMusic.h"
 #include "ILoadScreen.h"
+#include "IHandle.h"
+#include "IEngineEvent.h"
 #include "IUsings.h"
 
 namespace tle
 {
+	//Handles to the objects created by the engine
+	//Unlike pointers they can be checked before use and are never reused for a different object
+	//A pointer to a removed object can't be told apart from a new or pooled object given the same address,
+	//so removing by a stale pointer can remove someone else's object, only handles detect staleness
+	using AnimationHandle = SHandle<IAnimation>;
+	using EmitterHandle = SHandle<IParticleEmitter>;
+	using SoundHandle = SHandle<ISound>;
+	using MusicHandle = SHandle<IMusic>;
+
+	//A snapshot of the objects the engine is managing and an estimate of the memory they hold
+	//Byte counts only cover memory owned by the extension (containers, particles, sample data etc)
+	//Objects owned by TL-Xtreme (models, sprites) are reported as counts only
+	struct SEngineStats
+	{
+		//Meshes & models
+		int mMeshes;
+		int mCachedModels;
+		size_t mModelCacheBytes;
+
+		//Particles & emitters
+		int mEmitters;
+		int mDyingEmitters;
+		int mPooledEmitters;
+		int mActiveParticles;
+		int mInactiveParticles;
+		size_t mParticleBytes;
+
+		//Only measured while particle sorting is on
+		int mSortedParticles;
+		float mParticleOverdraw; //Estimated average number of particle layers drawn over each pixel of the screen
+
+		//Animations & sprites
+		int mAnimations;
+		int mAnimationSprites;
+		int mPooledSprites; //Parked sprites of removed animations waiting to be reused
+		int mOneShotAnimations; //Playing animations started by PlayOnce
+		int mPooledAnimations; //Finished one shot animations waiting to be played again
+		int mSprites;
+		size_t mAnimationBytes;
+
+		//Sound
+		int mSoundBuffers;
+		int mSounds;
+		size_t mSoundBufferBytes;
+
+		//Music
+		int mMusic;
+		size_t mMusicBytes;
+
+		//Sum of all the byte estimates above
+		size_t mTotalBytes;
+	};
+
 	class IEngine : public I3DEngine
 	{
 	public:
@@ -61,10 +117,13 @@ namespace tle
 		//Creates an animation at the given location
 		//Runs through the frames at a tick rate
 		//Return 0 if failed to load any of the animation frames
+		//Sprites parked by removed animations of the same frames are reused, any more needed are loaded
+		//Use PreloadAnimation so creating several instances at once doesn't load images
 		virtual IAnimation* CreateAnimation(const std::vector<string>& frameList,
 								const CVector3& position	= CVector3(0.0f, 0.0f, 0.0f),	/*Default location is the origin*/
 								const float		tickRate	= 0.1f,							/*Default rate is 10 frames per second*/
-								const bool		looped		= true							/*Set to loop the frames by default*/
+								const bool		looped		= true,							/*Set to loop the frames by default*/
+								const EAnimationMode mode	= AllFrames					/*Hold a sprite of every frame by default*/
 							) = 0;
 
 		//Creates an animation at the given location
@@ -73,12 +132,40 @@ namespace tle
 		virtual IAnimation* CreateAnimation(string& name, string& extension, int amount,
 								const CVector3& position	= CVector3(0.0f, 0.0f, 0.0f),	/*Default location is the origin*/
 								const float		tickRate	= 0.1f,							/*Default rate is 10 frames per second*/
-								const bool		looped		= true							/*Set to loop the frames by default*/
+								const bool		looped		= true,							/*Set to loop the frames by default*/
+								const EAnimationMode mode	= AllFrames					/*Hold a sprite of every frame by default*/
+							) = 0;
+
+		//Plays the frames once at the given location, the animation is recycled when it finishes
+		//Finished animations are pooled for each frame list so playing the same frames again creates no sprites
+		//While others of the same frames are still playing a new animation is needed, which loads its images
+		//unless enough instances have been preloaded with PreloadAnimation
+		//Returns false if any of the frames could not be loaded
+		virtual bool PlayOnce(const std::vector<string>& frameList,
+								const CVector3& position	= CVector3(0.0f, 0.0f, 0.0f),	/*Default location is the origin*/
+								const float		tickRate	= 0.1f,							/*Default rate is 10 frames per second*/
+								const EAnimationMode mode	= AllFrames					/*Hold a sprite of every frame by default*/
 							) = 0;
 
+		//Loads enough sprites of every frame for the number of instances of the animation to be alive at once
+		//Creating that many with CreateAnimation or PlayOnce then never loads an image, unless they are Streamed
+		//The sprites are kept when the frame set cache is cleared
+		//Returns false if any of the frames could not be loaded
+		virtual bool PreloadAnimation(const std::vector<string>& frameList, int instances) = 0;
+
 		//Remove the animation if it exists
+		//The pointer can't be checked for staleness, use a handle if the animation may already have been removed
 		virtual void RemoveAnimation(IAnimation* pAnimation) = 0;
 
+		//Remove the animation if the handle isn't stale
+		virtual void RemoveAnimation(AnimationHandle handle) = 0;
+
+		//Returns a handle to the animation, or a null handle if it doesn't exist
+		virtual AnimationHandle GetAnimationHandle(IAnimation* pAnimation) = 0;
+
+		//Returns the animation of the handle, or 0 if it has been removed
+		virtual IAnimation* GetAnimation(AnimationHandle handle) = 0;
+
 		////////////////////
 		//Particle Emitter//
 
@@ -96,8 +183,42 @@ namespace tle
 								const CVector3& position		= CVector3(0.0f, 0.0f, 0.0f)	/*Default location is the origin*/
 							) = 0;
 
+		//Create a particle emitter from a template at the given location
+		//Reuses an idle emitter of the template if there is one
+		virtual IParticleEmitter* CreateEmitter(IEmitterTemplate* pTemplate,
+								const CVector3& position		= CVector3(0.0f, 0.0f, 0.0f)	/*Default location is the origin*/
+							) = 0;
+
 		//Remove the particle emitter if it exists
-		virtual void RemoveEmitter(IParticleEmitter* emitter) = 0;
+		//The emitter stops and is kept until its particles have died, emitters spawned from a template are then kept for reuse
+		//A fade time of 0 or more cuts the life of the particles left alive to at most that many seconds
+		//The pointer can't be checked for staleness, pooled emitters are reissued at the same address,
+		//use a handle if the emitter may already have been removed
+		virtual void RemoveEmitter(IParticleEmitter* emitter, const float fadeTime = -1.0f) = 0;
+
+		//Remove the particle emitter if the handle isn't stale
+		//A fade time of 0 or more cuts the life of the particles left alive to at most that many seconds
+		virtual void RemoveEmitter(EmitterHandle handle, const float fadeTime = -1.0f) = 0;
+
+		//Returns a handle to the particle emitter, or a null handle if it doesn't exist
+		virtual EmitterHandle GetEmitterHandle(IParticleEmitter* emitter) = 0;
+
+		//Returns the particle emitter of the handle, or 0 if it has been removed
+		virtual IParticleEmitter* GetEmitter(EmitterHandle handle) = 0;
+
+		/////////////////////
+		//Emitter Templates//
+
+		//Creates an immutable effect definition that emitters can be spawned from
+		virtual IEmitterTemplate* CreateEmitterTemplate(const SEmitterSettings& settings) = 0;
+
+		//Loads an effect definition from a file of "setting value" lines
+		//Returns 0 if the file could not be loaded
+		virtual IEmitterTemplate* LoadEmitterTemplate(const string& file) = 0;
+
+		//Removes the template and its idle emitters
+		//Emitters already spawned from it keep working
+		virtual void RemoveEmitterTemplate(IEmitterTemplate* pTemplate) = 0;
 
 		/////////
 		//Sound//
@@ -107,8 +228,18 @@ namespace tle
 		virtual ISound* CreateSound(const std::string& soundFile) = 0;
 
 		//Removes the sound if it exists
+		//The pointer can't be checked for staleness, use a handle if the sound may already have been removed
 		virtual void RemoveSound(ISound* pSound) = 0;
 
+		//Removes the sound if the handle isn't stale
+		virtual void RemoveSound(SoundHandle handle) = 0;
+
+		//Returns a handle to the sound, or a null handle if it doesn't exist
+		virtual SoundHandle GetSoundHandle(ISound* pSound) = 0;
+
+		//Returns the sound of the handle, or 0 if it has been removed
+		virtual ISound* GetSound(SoundHandle handle) = 0;
+
 		/////////
 		//Music//
 
@@ -117,8 +248,25 @@ namespace tle
 		virtual IMusic* CreateMusic(const std::string& musicFile) = 0;
 
 		//Removes the music if it exists
+		//The pointer can't be checked for staleness, use a handle if the music may already have been removed
 		virtual void RemoveMusic(IMusic* pMusic) = 0;
 
+		//Removes the music if the handle isn't stale
+		virtual void RemoveMusic(MusicHandle handle) = 0;
+
+		//Returns a handle to the music, or a null handle if it doesn't exist
+		virtual MusicHandle GetMusicHandle(IMusic* pMusic) = 0;
+
+		//Returns the music of the handle, or 0 if it has been removed
+		virtual IMusic* GetMusic(MusicHandle handle) = 0;
+
+		//////////
+		//Events//
+
+		//Takes the oldest event queued by Timer, returns false once there are none left
+		//Drain the queue once a frame instead of checking every object, if left undrained the oldest events are dropped
+		virtual bool PollEvent(SEngineEvent& event) = 0;
+
 		/***************************************************
 						Additional Controls
 		****************************************************/
@@ -129,9 +277,35 @@ namespace tle
 		//Unpauses any auto updated entities eg animations and particles
 		virtual void UnpauseAutoUpdates() = 0;
 
+		//Updates every auto updated entity by the given time in seconds, even while auto updates are paused
+		//Ticks the animation clock, recycles finished one shot animations, updates live and dying emitters and
+		//queues the events they raise for PollEvent, which is the same work Timer does with the time it measures
+		//Timer only does it while auto updates aren't paused, so call PauseAutoUpdates first to run animations
+		//and particles at a fixed time step instead, otherwise both step them and they run too fast
+		//Sounds play on their own so still only raise events when Timer is called
+		virtual void StepAutoUpdates(float delta) = 0;
+
+		//Draws particles back to front across all emitters so blended particles overlap correctly
+		//Also measures the particle overdraw reported by GetStats, off by default
+		virtual void SetParticleSorting(bool sort) = 0;
+
+		//Returns true if particles are being sorted
+		virtual bool GetParticleSorting() = 0;
+
+		//Sets how far past the left and top of the window an animation can be before it is culled
+		//Culled animations keep playing but don't touch their sprites until they come back into view
+		//Should be at least the size of the largest animation frame, a negative margin turns culling off
+		virtual void SetAnimationCullMargin(float margin) = 0;
+
+		//Returns how far past the left and top of the window an animation can be before it is culled
+		virtual float GetAnimationCullMargin() = 0;
+
 		//Destroys all models and only models in the cache
 		virtual void ClearModelCache() = 0;
 
+		//Removes the sprites and finished one shot animations kept for reuse by animations that have been removed
+		virtual void ClearFrameSetCache() = 0;
+
 		//Destroys all meshes and therefore all models and particle emitters
 		virtual void ClearMeshCache() = 0;
 
@@ -146,5 +320,12 @@ namespace tle
 
 		//Gets the volume for the specific volume modifier
 		virtual float GetVolume(SoundType type) = 0;
+
+		/***************************************************
+							Diagnostics
+		****************************************************/
+
+		//Returns the number of objects of each subsystem and their estimated memory usage
+		virtual SEngineStats GetStats() = 0;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+#include "IHandle.h"
+
+namespace tle
+{
+	class IAnimation;
+	class IParticleEmitter;
+	class ISound;
+	class IMusic;
+
+	enum EEngineEventType
+	{
+		AnimationFinished,	//A non looped animation reached its last frame
+		EmitterDrained,		//A stopped emitter's last particle died
+		SoundStopped,		//A sound that was played has stopped, either reaching its end or by Stop()
+		MusicFinished		//Music that was played has stopped, either reaching its end or by Stop()
+	};
+
+	//Something that happened to an object during the engine's Timer
+	//Only the handle matching the type is set, the object may have been removed since the event was queued
+	//so check the handle with the engine before using it
+	struct SEngineEvent
+	{
+		EEngineEventType mType;
+		SHandle<IAnimation> mAnimation;
+		SHandle<IParticleEmitter> mEmitter;
+		SHandle<ISound> mSound;
+		SHandle<IMusic> mMusic;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+namespace tle
+{
+	//A weak reference to an object owned by the engine
+	//Made of the slot the object lives in and the generation of that slot, when the object is removed the
+	//generation is bumped so any handles still held to it are detected as stale instead of dangling
+	template<class T>
+	struct SHandle
+	{
+		int mIndex;
+		unsigned int mGeneration;
+
+		//Creates a null handle
+		SHandle() : mIndex(-1), mGeneration(0) {}
+
+		SHandle(int index, unsigned int generation) : mIndex(index), mGeneration(generation) {}
+
+		//Returns true if the handle was never given an object
+		//A handle that isn't null may still be stale, ask the engine for the object to check
+		bool IsNull() const { return mIndex < 0; }
+
+		bool operator==(const SHandle& other) const { return mIndex == other.mIndex && mGeneration == other.mGeneration; }
+		bool operator!=(const SHandle& other) const { return !(*this == other); }
+	};
+}
\ No newline at end of file
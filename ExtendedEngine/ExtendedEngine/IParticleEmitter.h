@@ -7,6 +7,7 @@
 namespace tle
 {
 	enum EEmissionType { Sphere, Circle, Cone, Arch, Line };
+	enum ECollisionResponse { Bounce, Kill };
 
 	const float FASTEST_EMISSION_RATE = 0.0099f;
 	const string PARTICLE_MODEL = "Quad.x";
@@ -26,16 +27,45 @@ namespace tle
 		virtual void Stop() = 0;
 
 		//Sets all particles to the despawned (inactive) state
+		//The particles keep their quads so restarting the emitter doesn't go back through the model cache
 		virtual void Reset() = 0;
 
 		//Clears local cache of particles
 		//Returns all particles back to the engine
 		virtual void Clear() = 0;
 
-		//Do not call
+		//Allocates enough particles for the amount to be alive at once and gives them their models up front
+		//Also fills the model cache with quads for every texture of an animated skin
+		//An amount of 0 or less reserves enough for the current emission rate and particle life
+		//Call after setting the particle skin, life and emission rate
+		virtual void Reserve(int amount = 0) = 0;
+
+		//Simulates the emitter for the given amount of time so it starts at a steady state
+		//A time of 0 or less simulates a single particle life time
+		//Call after setting up the emitter, only spawns particles if the emitter is started
+		virtual void PreWarm(float time = 0.0f) = 0;
+
 		//Called from the engine to auto update the particles and emitter
+		//While auto updates are paused it can be called with a recorded stream of deltas to replay the emitter
 		virtual void Update(float delta) = 0;
 
+		/************************************
+					Determinism
+		*************************************/
+
+		//Restarts the emitter's random number generator from the seed
+		//The generator picks the direction each particle is emitted in
+		//Reset then seed the emitter before replaying it
+		virtual void SetRandomSeed(unsigned int seed) = 0;
+
+		//Simulates the emitter in fixed steps of the given time in seconds, left over time is carried to the next update
+		//With a fixed step and seed, replaying the same deltas gives identical particles
+		//A step of 0 or less simulates with the delta given to each update, the default
+		virtual void SetFixedTimestep(float step) = 0;
+
+		//Returns the fixed step the emitter is simulated with, 0 if it uses the update delta
+		virtual float GetFixedTimestep() = 0;
+
 		//Do not call
 		//Called from the engine to orientate the particles
 		//To either face or hide behind the camera
@@ -49,10 +79,13 @@ namespace tle
 		//Emitter//
 
 		//Emission type decides what direction the particles are emitted
+		//The direction of the particle velocity is turned, keeping its speed: Line keeps it, Sphere turns it any way,
+		//Cone within the emission angle of it, Circle to a ring at right angles to it and Arch to a fan within the angle
+		//turning towards the emitter's x axis. The particle's acceleration turns with it
 		virtual void SetEmissionType(EEmissionType type) = 0;
 
-		//Set the variance in the direction the particles are emitted
-		//Only affects non circular/linear emissions.
+		//Set the variance in degrees in the direction the particles are emitted
+		//Only affects cone and arch emissions
 		virtual void SetEmissionAngle(float angle) = 0;
 
 		//Set the amount of time in seconds between particles being emitted
@@ -83,6 +116,53 @@ namespace tle
 		//Does not retroactively change scale of existing particles
 		virtual void SetParticleScale(float scale) = 0;
 
+		//Gives every particle its own quad for each frame of an animated skin
+		//Changing frame then only moves quads instead of swapping them through the model cache
+		//Uses a quad per frame per particle so is best for short animations on busy effects
+		//The quads of frames not being shown are moved behind the camera each draw, costing a position change
+		//for each rather than a draw call
+		virtual void SetParticleFlipbook(bool flipbook) = 0;
+
+		//Set how the particle scale changes over the particle's life
+		//The keys are multipliers of the particle scale spread evenly from birth to death, eg {0.5, 1, 0} grows then shrinks
+		//An empty list turns the curve off
+		virtual void SetParticleScaleCurve(const std::vector<float>& keys) = 0;
+
+		//Set how much the particles are slowed down over their life
+		//The keys are the fraction of velocity lost per second spread evenly from birth to death
+		//An empty list turns the curve off
+		virtual void SetParticleDragCurve(const std::vector<float>& keys) = 0;
+
+		/////////////
+		//Collision//
+
+		//Adds a plane, given by a point on it and the normal of the side particles stay on, that particles can't pass through
+		//Bouncing particles keep the bounciness fraction of their speed into the plane
+		//Returns false if the emitter already has the most planes it can hold
+		virtual bool AddCollisionPlane(const CVector3& point, const CVector3& normal,
+								ECollisionResponse response = Bounce, float bounciness = 0.5f) = 0;
+
+		//Adds a solid sphere that particles can't pass into
+		//Bouncing particles keep the bounciness fraction of their speed into the sphere
+		//Returns false if the emitter already has the most spheres it can hold
+		virtual bool AddCollisionSphere(const CVector3& centre, float radius,
+								ECollisionResponse response = Bounce, float bounciness = 0.5f) = 0;
+
+		//Removes all collision planes and spheres
+		virtual void ClearCollision() = 0;
+
+		//////////////
+		//Attachment//
+
+		//Attaches the emitter to the scene node so it follows the node without being moved every frame
+		//The offset is relative to the node and turns with it, the node's matrix is read once each update
+		//Emitters aren't part of the TL-Engine's scene so TL-Engine nodes can't be attached to an emitter
+		//The emitter is detached when it is removed
+		virtual void AttachTo(ISceneNode* parent, const CVector3& offset = CVector3(0.0f, 0.0f, 0.0f)) = 0;
+
+		//Detaches the emitter from the scene node it was attached to
+		virtual void Detach() = 0;
+
 		/************************************
 						Gets
 		*************************************/
@@ -123,6 +203,15 @@ namespace tle
 		//Returns the scale of the particle quad model
 		virtual float GetParticleScale() = 0;
 
+		//Returns true if every particle has its own quad for each frame
+		virtual bool GetParticleFlipbook() = 0;
+
+		//Returns the keys of the scale curve, empty if there is none
+		virtual std::vector<float> GetParticleScaleCurve() = 0;
+
+		//Returns the keys of the drag curve, empty if there is none
+		virtual std::vector<float> GetParticleDragCurve() = 0;
+
 		/************************************
 				 Goodbye Cruel World
 		*************************************/
@@ -1,5 +1,5 @@
 #pragma once
-#include "SFML\Audio\SoundSource.hpp"
+#include "SFML/Audio/SoundSource.hpp"
 
 namespace tle
 {